@@ -0,0 +1,134 @@
+//
+//  BenchHarness.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+// runs the benchmark cases over the block sizes and the sample rates, and writes the results as JSON
+// - a case is a factory, called for each configuration, that prepares the object and returns the block function
+// - the block function processes l samples (or items) from pi into po, it is timed over the repeated blocks
+// - each configuration is measured Repeats times, the median and the minimum of the ns/sample are reported
+class BenchHarness
+{
+public:
+	enum { Repeats = 5 };
+	using BlockFn = std::function<void(const float* pi, float* po, int l)>;
+	using Factory = std::function<BlockFn(double fs, int block)>;
+	struct Case
+	{
+		std::string name;
+		Factory factory;
+		bool ratedependent;
+	};
+	struct Result
+	{
+		std::string name;
+		int block;
+		double samplerate; // 0 when the case does not depend on it
+		double nsmedian, nsmin;
+	};
+	std::vector<Case> mCases;
+	std::vector<int> mBlockSizes;
+	std::vector<double> mSampleRates;
+	std::string mFilter;
+	double mTimePerConfig; // in seconds
+	std::vector<Result> mResults;
+	float mSink; // keeps the outputs alive
+	BenchHarness()
+	{
+		mBlockSizes = { 64, 256, 1024 };
+		mSampleRates = { 44100, 48000, 96000 };
+		mTimePerConfig = 0.05;
+		mSink = 0;
+	}
+	void Add(const std::string& name, Factory factory, bool ratedependent = true)
+	{
+		mCases.push_back({ name, factory, ratedependent });
+	}
+	void Run()
+	{
+		int maxblock = *std::max_element(mBlockSizes.begin(), mBlockSizes.end());
+		std::vector<float> in((size_t)maxblock), out((size_t)maxblock);
+		// white noise in [-1,1), deterministic
+		uint32_t seed = 22222;
+		for(auto&& v : in) { seed = seed * 196314165u + 907633515u; v = (float)(int32_t)seed * (1.0f / 2147483648.0f); }
+		for(const Case& c : mCases)
+		{
+			if(!mFilter.empty() && (c.name.find(mFilter) == std::string::npos)) continue;
+			for(double fs : mSampleRates)
+			{
+				for(int block : mBlockSizes)
+				{
+					mResults.push_back(internalMeasure(c, fs, block, in.data(), out.data()));
+					const Result& r = mResults.back();
+					std::fprintf(stderr, "%-40s block=%-5d fs=%-6.0f %8.3f ns/sample\n", r.name.c_str(), r.block, r.samplerate, r.nsmedian);
+				}
+				if(!c.ratedependent) break;
+			}
+		}
+	}
+	// the extra fields are written into the top level object as they are, e.g. "\"compiler\": \"gcc\""
+	void WriteJSON(FILE* fp, const std::vector<std::string>& extras) const
+	{
+		std::fprintf(fp, "{\n");
+		for(const std::string& s : extras) std::fprintf(fp, "\t%s,\n", s.c_str());
+		std::fprintf(fp, "\t\"results\": [\n");
+		for(size_t c = mResults.size(), i = 0; i < c; i ++)
+		{
+			const Result& r = mResults[i];
+			std::fprintf(fp, "\t\t{ \"name\": \"%s\", \"block\": %d, \"samplerate\": ", JSONEscape(r.name).c_str(), r.block);
+			if(0 < r.samplerate) std::fprintf(fp, "%.0f", r.samplerate);
+			else std::fprintf(fp, "null");
+			std::fprintf(fp, ", \"ns_per_sample\": %.4f, \"ns_per_sample_min\": %.4f, \"samples_per_sec\": %.1f }%s\n",
+				r.nsmedian, r.nsmin, (0 < r.nsmedian) ? (1e9 / r.nsmedian) : 0.0, (i + 1 < c) ? "," : "");
+		}
+		std::fprintf(fp, "\t]\n}\n");
+	}
+	static std::string JSONEscape(const std::string& s)
+	{
+		std::string r;
+		for(char ch : s)
+		{
+			if((ch == '"') || (ch == '\\')) { r += '\\'; r += ch; }
+			else if((unsigned char)ch < 0x20) { char t[8]; std::snprintf(t, sizeof(t), "\\u%04x", (unsigned)ch); r += t; }
+			else r += ch;
+		}
+		return r;
+	}
+	// for the internal use
+	Result internalMeasure(const Case& c, double fs, int block, const float* pi, float* po)
+	{
+		using Clock = std::chrono::steady_clock;
+		BlockFn fn = c.factory(fs, block);
+		// warm up, and estimate the blocks per repeat
+		Clock::time_point t0 = Clock::now();
+		long long nwarm = 0;
+		do { fn(pi, po, block); nwarm ++; } while(std::chrono::duration<double>(Clock::now() - t0).count() < (mTimePerConfig * 0.2));
+		double tblock = std::chrono::duration<double>(Clock::now() - t0).count() / (double)nwarm;
+		long long nblocks = std::max(1LL, (long long)(mTimePerConfig / Repeats / tblock));
+		double ns[Repeats];
+		for(int ir = 0; ir < Repeats; ir ++)
+		{
+			Clock::time_point t1 = Clock::now();
+			for(long long ib = 0; ib < nblocks; ib ++) fn(pi, po, block);
+			double t = std::chrono::duration<double, std::nano>(Clock::now() - t1).count();
+			ns[ir] = t / ((double)nblocks * (double)block);
+			mSink += po[0] + po[block - 1];
+		}
+		std::sort(ns, ns + Repeats);
+		return { c.name, block, c.ratedependent ? fs : 0, ns[Repeats / 2], ns[0] };
+	}
+};
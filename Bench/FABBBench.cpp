@@ -0,0 +1,335 @@
+//
+//  FABBBench.cpp
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+//  microbenchmarks of the DSP building blocks, writes the results as JSON
+//  usage: fabb_bench [--filter <substring>] [--time <ms per configuration>] [--quick] [--out <path>]
+//
+
+#include "BenchHarness.h"
+#include "ChannelVocoder.h"
+#include "PulseInstrument.h"
+#include "VocoderCore.h"
+#include "VocoderParams.h"
+#include "FABB/BLT.h"
+#include "FABB/BlitOscillator.h"
+#include "FABB/CurveMapping.h"
+#include "FABB/EnvelopeFollower.h"
+#include "FABB/FastMath.h"
+#include "FABB/ParamConvert.h"
+#include "FABB/SineOscillator.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifndef FABB_BENCH_ARCH_FLAGS
+#define FABB_BENCH_ARCH_FLAGS ""
+#endif
+
+// per-sample objects, o.Process(v) for each sample
+template<class T> static BenchHarness::BlockFn FilterBlock(std::shared_ptr<T> po)
+{
+	return [po](const float* pi, float* pd, int l) { T& o = *po; for(int i = 0; i < l; i ++) pd[i] = o.Process(pi[i]); };
+}
+
+// generators, o.Process() for each sample
+template<class T> static BenchHarness::BlockFn GeneratorBlock(std::shared_ptr<T> po)
+{
+	return [po](const float*, float* pd, int l) { T& o = *po; for(int i = 0; i < l; i ++) pd[i] = o.Process(); };
+}
+
+template<class TIIR> static BenchHarness::Factory RBJBandPass()
+{
+	return [](double fs, int)
+	{
+		auto p = std::make_shared<FABB::RBJFilterT<float, TIIR>>();
+		p->SetType(FABB::RBJFilterT<float, TIIR>::Type::BP);
+		p->SetFreq(1000.0f / (float)fs);
+		p->SetQ(8);
+		return FilterBlock(p);
+	};
+}
+
+template<class TMath> static BenchHarness::Factory Blit()
+{
+	return [](double fs, int)
+	{
+		auto p = std::make_shared<FABB::BlitOscillatorT<float, TMath>>();
+		p->SetFreq(220.0f / (float)fs);
+		return GeneratorBlock(p);
+	};
+}
+
+template<class TMath> static BenchHarness::Factory Sine()
+{
+	return [](double fs, int)
+	{
+		auto p = std::make_shared<FABB::SineOscillatorT<float, TMath>>();
+		p->SetFreq(440.0f / (float)fs);
+		return GeneratorBlock(p);
+	};
+}
+
+template<class TMath> static BenchHarness::Factory CurveMapExp()
+{
+	return [](double, int)
+	{
+		auto p = std::make_shared<FABB::CurveMapExponential<float, TMath>>(0.0f, 1.0f, 20.0f, 20000.0f);
+		return BenchHarness::BlockFn([p](const float* pi, float* pd, int l) { for(int i = 0; i < l; i ++) pd[i] = p->Map(std::abs(pi[i])); });
+	};
+}
+
+// fn(pi, po, l) is the array function of FastMath or the std:: loop
+static BenchHarness::Factory MathArray(void(*fn)(const float*, float*, size_t), float scale, float offset)
+{
+	return [=](double, int block)
+	{
+		auto px = std::make_shared<std::vector<float>>((size_t)block);
+		return BenchHarness::BlockFn([=](const float* pi, float* pd, int l)
+		{
+			float* x = px->data();
+			for(int i = 0; i < l; i ++) x[i] = pi[i] * scale + offset;
+			fn(x, pd, (size_t)l);
+		});
+	};
+}
+
+static void StdExp2(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::exp2(pi[i]); }
+static void StdExp(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::exp(pi[i]); }
+static void StdLog2(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::log2(pi[i]); }
+static void StdLog(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::log(pi[i]); }
+static void StdSin(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::sin(pi[i]); }
+static void StdCos(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::cos(pi[i]); }
+static void StdTan(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::tan(pi[i]); }
+// x^2.5, as a gamma curve
+static void StdPow(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = std::pow(pi[i], 2.5f); }
+static void FastPow(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = FABB::FastMath::Pow(pi[i], 2.5f); }
+
+// the instrument with n notes held in the poly mode, or 1 note in the mono mode, each with the unison sub-voices
+static BenchHarness::Factory Instrument(int n, int unison = 1)
+{
+	return [n, unison](double fs, int)
+	{
+		auto p = std::make_shared<PulseInstrument>();
+		p->Prepare(fs);
+		p->setMonoMode(n <= 1);
+		p->SetUnisonCount(unison);
+		p->SetUnisonDetune(0.25f);
+		for(int i = 0; i < n; i ++) p->NoteOn(48 + 5 * i);
+		return BenchHarness::BlockFn([p](const float*, float* pd, int l) { p->Process(pd, l); });
+	};
+}
+
+// the items of the MIDI sequence given to VocoderCore::Process()
+struct MidiEvent
+{
+	int samplePosition;
+	const uint8_t* data;
+	int numBytes;
+};
+
+// the whole engine as the plugin runs it, with a preset and n notes held, mono in and out
+static BenchHarness::Factory Core(int program, int n)
+{
+	return [program, n](double fs, int block)
+	{
+		auto p = std::make_shared<VocoderCore>();
+		p->Prepare(fs, block, 1, 1, 1);
+		p->SelectProgram(program);
+		auto pm = std::make_shared<std::vector<float>>((size_t)block);
+		auto pnotes = std::make_shared<std::vector<uint8_t>>();
+		auto pev = std::make_shared<std::vector<MidiEvent>>();
+		for(int i = 0; i < n; i ++) pnotes->insert(pnotes->end(), { 0x90, (uint8_t)(48 + 5 * i), 100 });
+		for(int i = 0; i < n; i ++) pev->push_back({ 0, pnotes->data() + 3 * i, 3 });
+		return BenchHarness::BlockFn([p, pm, pnotes, pev](const float* pi, float* pd, int l)
+		{
+			// the modulator channel is overwritten in place
+			for(int i = 0; i < l; i ++) { pd[i] = pi[i]; (*pm)[(size_t)i] = std::sin((float)i * 0.05f); }
+			float* ppch[2] = { pd, pm->data() };
+			p->Process(ppch, 2, l, *pev);
+			pev->clear(); // the notes are held after the first block
+		});
+	};
+}
+
+// the control values swept over [0,1], as the automation does
+static std::vector<float> ControlRamp(int block)
+{
+	std::vector<float> v((size_t)block);
+	for(int i = 0; i < block; i ++) v[(size_t)i] = (float)i / (float)std::max(1, block - 1);
+	return v;
+}
+
+int main(int argc, char* argv[])
+{
+	BenchHarness bh;
+	const char* outpath = nullptr;
+	for(int i = 1; i < argc; i ++)
+	{
+		if((std::strcmp(argv[i], "--filter") == 0) && (i + 1 < argc)) bh.mFilter = argv[++ i];
+		else if((std::strcmp(argv[i], "--time") == 0) && (i + 1 < argc)) bh.mTimePerConfig = std::atof(argv[++ i]) * 0.001;
+		else if(std::strcmp(argv[i], "--quick") == 0) { bh.mTimePerConfig = 0.005; bh.mSampleRates = { 48000 }; }
+		else if((std::strcmp(argv[i], "--out") == 0) && (i + 1 < argc)) outpath = argv[++ i];
+		else { std::fprintf(stderr, "usage: %s [--filter <substring>] [--time <ms>] [--quick] [--out <path>]\n", argv[0]); return 1; }
+	}
+
+	// filters
+	bh.Add("RBJFilterF/BP/DF-I", RBJBandPass<FABB::DirectFormI::IIR2T<float>>());
+	bh.Add("RBJFilterF/BP/TDF-II", RBJBandPass<FABB::TransposedDirectFormII::IIR2T<float>>());
+	bh.Add("CascadedBPF", [](double fs, int)
+	{
+		auto p = std::make_shared<CascadedBPF>();
+		p->SetFreq(1000.0f / (float)fs);
+		return FilterBlock(p);
+	});
+	bh.Add("EnvelopeFollowerF", [](double fs, int)
+	{
+		auto p = std::make_shared<FABB::EnvelopeFollowerF>();
+		p->SetAttackTC(0.01f * (float)fs);
+		p->SetReleaseTC(0.1f * (float)fs);
+		return FilterBlock(p);
+	});
+	bh.Add("LagFilterF", [](double fs, int)
+	{
+		auto p = std::make_shared<FABB::LagFilterF>();
+		p->SetTC(0.01f * (float)fs);
+		return FilterBlock(p);
+	});
+
+	// generators
+	bh.Add("BlitOscillatorF/precise", Blit<FABB::MathPolicyPrecise>());
+	bh.Add("BlitOscillatorF/fast", Blit<FABB::MathPolicyFast>());
+	bh.Add("SineOscillatorF/precise", Sine<FABB::MathPolicyPrecise>());
+	bh.Add("SineOscillatorF/fast", Sine<FABB::MathPolicyFast>());
+	bh.Add("NoiseGenerator", [](double, int) { return GeneratorBlock(std::make_shared<NoiseGenerator>()); }, false);
+
+	// math
+	bh.Add("CurveMapExponentialF::Map/precise", CurveMapExp<FABB::MathPolicyPrecise>(), false);
+	bh.Add("CurveMapExponentialF::Map/fast", CurveMapExp<FABB::MathPolicyFast>(), false);
+	bh.Add("std::exp2", MathArray(StdExp2, 8, 0), false);
+	bh.Add("FastMath::Exp2", MathArray(FABB::FastMath::Exp2, 8, 0), false);
+	bh.Add("std::exp", MathArray(StdExp, 8, 0), false);
+	bh.Add("FastMath::Exp", MathArray(FABB::FastMath::Exp, 8, 0), false);
+	bh.Add("std::log2", MathArray(StdLog2, 0.5f, 1), false);
+	bh.Add("FastMath::Log2", MathArray(FABB::FastMath::Log2, 0.5f, 1), false);
+	bh.Add("std::log", MathArray(StdLog, 0.5f, 1), false);
+	bh.Add("FastMath::Log", MathArray(FABB::FastMath::Log, 0.5f, 1), false);
+	bh.Add("std::pow", MathArray(StdPow, 0.5f, 1), false);
+	bh.Add("FastMath::Pow", MathArray(FastPow, 0.5f, 1), false);
+	bh.Add("std::sin", MathArray(StdSin, 3.14159265f, 0), false);
+	bh.Add("FastMath::Sin", MathArray(FABB::FastMath::Sin, 3.14159265f, 0), false);
+	bh.Add("std::cos", MathArray(StdCos, 3.14159265f, 0), false);
+	bh.Add("FastMath::Cos", MathArray(FABB::FastMath::Cos, 3.14159265f, 0), false);
+	bh.Add("std::tan", MathArray(StdTan, 1.5f, 0), false);
+	bh.Add("FastMath::Tan", MathArray(FABB::FastMath::Tan, 1.5f, 0), false);
+
+	// engines
+	bh.Add("ChannelVocoder::Process", [](double fs, int block)
+	{
+		auto p = std::make_shared<ChannelVocoder>();
+		p->Prepare(fs, block);
+		auto pm = std::make_shared<std::vector<float>>((size_t)block);
+		for(int i = 0; i < block; i ++) (*pm)[(size_t)i] = std::sin((float)i * 0.05f);
+		return BenchHarness::BlockFn([p, pm](const float* pi, float* pd, int l) { p->Process(pi, pm->data(), pd, l); });
+	});
+	bh.Add("ChannelVocoder::Analyze+Synthesize", [](double fs, int block)
+	{
+		auto p = std::make_shared<ChannelVocoder>();
+		p->Prepare(fs, block);
+		auto pm = std::make_shared<std::vector<float>>((size_t)block);
+		for(int i = 0; i < block; i ++) (*pm)[(size_t)i] = std::sin((float)i * 0.05f);
+		return BenchHarness::BlockFn([p, pm](const float* pi, float* pd, int l) { p->Analyze(pm->data(), l); p->Synthesize(pi, pd, l); });
+	});
+	bh.Add("PulseInstrument::Process/1voice", Instrument(1));
+	bh.Add("PulseInstrument::Process/4voices", Instrument(4));
+	bh.Add("PulseInstrument::Process/8voices", Instrument(8));
+	bh.Add("PulseInstrument::Process/8voices/unison4", Instrument(8, 4));
+	bh.Add("PulseInstrument::Process/8voices/unison8", Instrument(8, 8));
+	bh.Add("VocoderCore::Process/Choir/8voices", Core(2, 8));
+
+	// parameters, per value (or per call)
+	auto table = std::make_shared<FABB::ParamConverterTable>(gParamProfile, (size_t)ParamID::Count);
+	bh.Add("ParamConverter::ControlToNative", [table](double, int block)
+	{
+		auto pv = std::make_shared<std::vector<float>>(ControlRamp(block));
+		const FABB::ParamConverter* pc = (*table)["CG"];
+		return BenchHarness::BlockFn([pc, pv](const float*, float* pd, int l) { for(int i = 0; i < l; i ++) pd[i] = pc->ControlToNative((*pv)[(size_t)i]); });
+	}, false);
+	bh.Add("ParamConverter::ControlToNative[]", [table](double, int block)
+	{
+		auto pv = std::make_shared<std::vector<float>>(ControlRamp(block));
+		const FABB::ParamConverter* pc = (*table)["CG"];
+		return BenchHarness::BlockFn([pc, pv](const float*, float* pd, int l) { pc->ControlToNative(pv->data(), pd, (size_t)l); });
+	}, false);
+	bh.Add("ParamConverter::Format", [table](double, int block)
+	{
+		auto pv = std::make_shared<std::vector<float>>(ControlRamp(block));
+		const FABB::ParamConverter* pc = (*table)["IPT"];
+		return BenchHarness::BlockFn([pc, pv](const float*, float* pd, int l)
+		{
+			char s[FABB::ParamConverter::MaxTextLength];
+			for(int i = 0; i < l; i ++) { pc->Format((*pv)[(size_t)i], s, sizeof(s)); pd[i] = (float)s[0]; }
+		});
+	}, false);
+	bh.Add("ParamConverter::Parse", [table](double, int block)
+	{
+		const FABB::ParamConverter* pc = (*table)["IPT"];
+		auto ps = std::make_shared<std::vector<std::string>>();
+		for(float v : ControlRamp(block)) ps->push_back(pc->Format(v));
+		return BenchHarness::BlockFn([pc, ps](const float*, float* pd, int l) { for(int i = 0; i < l; i ++) pd[i] = pc->Parse((*ps)[(size_t)i].c_str()); });
+	}, false);
+	// the display texts of all the parameters, as the host refreshes the generic editor
+	bh.Add("ParamConverter::Format/all", [table](double, int)
+	{
+		return BenchHarness::BlockFn([table](const float* pi, float* pd, int l)
+		{
+			char s[FABB::ParamConverter::MaxTextLength];
+			for(int i = 0; i < l; i ++)
+			{
+				const FABB::ParamConverter* pc = (*table)[(size_t)i % (size_t)ParamID::Count];
+				pc->Format(std::abs(pi[i]), s, sizeof(s));
+				pd[i] = (float)s[0];
+			}
+		});
+	}, false);
+	// the profile parsing, per parameter
+	bh.Add("ParamConverterTable::Load", [](double, int block)
+	{
+		auto pp = std::make_shared<std::vector<const char*>>();
+		for(int i = 0; i < block; i ++) pp->push_back(gParamProfile[(size_t)i % (size_t)ParamID::Count]);
+		return BenchHarness::BlockFn([pp](const float*, float* pd, int l)
+		{
+			FABB::ParamConverterTable t(pp->data(), (size_t)l);
+			pd[0] = (float)t.Count();
+			pd[l - 1] = t[(size_t)0]->ControlDef();
+		});
+	}, false);
+
+	bh.Run();
+
+	std::vector<std::string> extras =
+	{
+		"\"suite\": \"fabb_bench\"",
+#if defined(__VERSION__)
+		"\"compiler\": \"" + BenchHarness::JSONEscape(__VERSION__) + "\"",
+#elif defined(_MSC_FULL_VER)
+		"\"compiler\": \"MSVC " + std::to_string(_MSC_FULL_VER) + "\"",
+#endif
+		"\"arch_flags\": \"" + BenchHarness::JSONEscape(FABB_BENCH_ARCH_FLAGS) + "\"",
+		std::string("\"fastmath_default\": ") + (std::is_same<FABB::MathPolicyDefault, FABB::MathPolicyFast>::value ? "true" : "false"),
+		"\"time_per_config_ms\": " + std::to_string(bh.mTimePerConfig * 1000),
+	};
+	FILE* fp = outpath ? std::fopen(outpath, "w") : stdout;
+	if(!fp) { std::fprintf(stderr, "cannot open %s\n", outpath); return 1; }
+	bh.WriteJSON(fp, extras);
+	if(fp != stdout) std::fclose(fp);
+	return 0;
+}
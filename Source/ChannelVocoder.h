@@ -10,7 +10,12 @@
 
 #include "FABB/EnvelopeFollower.h"
 #include "FABB/BLT.h"
+#include "FABB/Arena.h"
+#include "FABB/FastMath.h"
+#include "FABB/ParamSmoother.h"
+#include <algorithm>
 #include <array>
+#include <cmath>
 #include <cstdint>
 
 //
@@ -75,33 +80,60 @@ public:
 class ChannelVocoder
 {
 public:
+	using MathPolicy = FABB::MathPolicyDefault;
 	enum { BandCount = 16 };
 	std::array<CascadedBPF, BandCount> mBPFC, mBPFM;
 	std::array<FABB::EnvelopeFollowerF, BandCount> mEnvD;
 	NoiseGenerator mNoiseGen;
-	float mNoiseGain;
+	FABB::GridSmootherF mNoiseGain; // on the grid from Prepare(), see GridSmootherT
 	int mBandShift;
+	// work buffers for the block processing, see Analyze() and Synthesize()
+	// carved from the arena given to Prepare(), or from mOwnArena
+	float* mEnvBuffer; // [BandCount][mMaxBlockSize]
+	float* mNoiseBuffer; // [mMaxBlockSize]
+	int mMaxBlockSize;
+	FABB::Arena mOwnArena;
+	// sum of squares of the band-passed modulator, accumulated until TakeModRMS()
+	std::array<float, BandCount> mModSumSq;
+	int mModSumCount;
 	ChannelVocoder()
 	{
-		mNoiseGain = 0;
 		mBandShift = 0;
+		mEnvBuffer = mNoiseBuffer = nullptr;
+		mMaxBlockSize = 0;
+		mModSumSq.fill(0);
+		mModSumCount = 0;
 	}
 	void setNoiseGain(float v)
 	{
-		mNoiseGain = v;
+		mNoiseGain.SetTarget(v);
 	}
 	void SetBandShift(int v)
 	{
 		mBandShift = v;
 		Reset();
 	}
-	void Prepare(double fs)
+	// the bytes that Prepare() takes from the arena
+	static size_t ArenaFootprint(int maxblock)
 	{
+		size_t l = (size_t)std::max(0, maxblock);
+		return FABB::Arena::Footprint<float>((size_t)BandCount * l) + FABB::Arena::Footprint<float>(l);
+	}
+	// parena: has ArenaFootprint(maxblock) bytes available, or nullptr to use the own arena
+	void Prepare(double fs, int maxblock = 0, FABB::Arena* parena = nullptr)
+	{
+		mMaxBlockSize = std::max(0, maxblock);
+		if(!parena) { mOwnArena.Reserve(ArenaFootprint(mMaxBlockSize)); parena = &mOwnArena; }
+		mEnvBuffer = parena->Allocate<float>((size_t)BandCount * (size_t)mMaxBlockSize);
+		mNoiseBuffer = parena->Allocate<float>((size_t)mMaxBlockSize);
 		float samplerate = (float)fs;
+		mNoiseGain.SetTime(0.01f * samplerate);
+		mNoiseGain.Snap();
+		mNoiseGain.Align();
 		for(int i = 0; i < BandCount; i ++)
 		{
 			// fo=500*(2^([-5:10]/3))
-			float fo = 500 * std::pow(2.0f, (float)(i - 5) / 3.0f);
+			float fo = 500 * MathPolicy::Exp2((float)(i - 5) / 3.0f);
 			mBPFC[i].SetFreq(fo / samplerate);
 			mBPFM[i].SetFreq(fo / samplerate);
 			mEnvD[i].SetAttackTC(0.01f * samplerate);
@@ -120,6 +152,8 @@ public:
 			mBPFM[i].Reset();
 			mEnvD[i].Reset();
 		}
+		mModSumSq.fill(0);
+		mModSumCount = 0;
 	}
 	void GetModLevels(std::array<float, BandCount>* pv) const
 	{
@@ -129,22 +163,95 @@ public:
 			pv->at(i) = ((0 <= im) && (im < BandCount)) ? mEnvD[im].GetValue() : 0;
 		}
 	}
+	// RMS of the bands since the last call, and restarts the accumulation
+	void TakeModRMS(std::array<float, BandCount>* pv)
+	{
+		float rcp = (0 < mModSumCount) ? (1.0f / (float)mModSumCount) : 0.0f;
+		for(int i = 0; i < BandCount; i ++)
+		{
+			int im = i - mBandShift;
+			pv->at(i) = ((0 <= im) && (im < BandCount)) ? std::sqrt(mModSumSq[im] * rcp) : 0;
+		}
+		mModSumSq.fill(0);
+		mModSumCount = 0;
+	}
+	// takes the noise gain as it is, the smoothing advances only in the block processing
 	float Process(float vc, float vm)
+	{
+		return internalProcess(vc, vm, mNoiseGain.GetValue());
+	}
+	void Process(const float* pc, const float* pm, float* po, int l)
+	{
+		mNoiseGain.Ramp(l, [&](int i, int n, float ng0, float dng)
+		{
+			for(int k = 0; k < n; k ++) po[i + k] = internalProcess(pc[i + k], pm[i + k], ng0 + dng * (float)k);
+		});
+	}
+	// for the internal use
+	float internalProcess(float vc, float vm, float ng)
 	{
 		static const float NoiseBands[BandCount] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1 };
-		float vn = mNoiseGen.Process() * mNoiseGain;
+		float vn = mNoiseGen.Process() * ng;
 		float vo = 0;
 		for(int i = 0; i < BandCount; i ++)
 		{
 			int im = i - mBandShift;
-			float vmi = ((0 <= im) && (im < BandCount)) ? mEnvD[im].Process(mBPFM[im].Process(vm)) : 0;
+			float vmi = 0;
+			if((0 <= im) && (im < BandCount))
+			{
+				float vb = mBPFM[im].Process(vm);
+				mModSumSq[im] += vb * vb;
+				vmi = mEnvD[im].Process(vb);
+			}
 			float vci = mBPFC[i].Process(vc + vn * NoiseBands[i]);
 			vo += vmi * vci;
 		}
+		mModSumCount ++;
 		return vo;
 	}
-	void Process(const float* pc, const float* pm, float* po, int l)
+	// the block processing is splitted into 2 passes, Analyze() and then Synthesize(),
+	// so that the modulator analysis can run while the carrier is being prepared
+	// the results are identical to Process(), l must not exceed the maxblock given to Prepare()
+	int GetMaxBlockSize() const
+	{
+		return mMaxBlockSize;
+	}
+	void Analyze(const float* pm, int l)
+	{
+		for(int im = 0; im < BandCount; im ++)
+		{
+			float* pe = mEnvBuffer + (size_t)im * (size_t)mMaxBlockSize;
+			CascadedBPF& bpf = mBPFM[im];
+			FABB::EnvelopeFollowerF& env = mEnvD[im];
+			float ss = 0;
+			for(int i = 0; i < l; i ++)
+			{
+				float vb = bpf.Process(pm[i]);
+				ss += vb * vb;
+				pe[i] = env.Process(vb);
+			}
+			mModSumSq[im] += ss;
+		}
+		mModSumCount += l;
+	}
+	// po must not alias pc
+	void Synthesize(const float* pc, float* po, int l)
 	{
-		while(l --) *po ++ = Process(*pc ++, *pm ++);
+		static const float NoiseBands[BandCount] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1 };
+		float* pn = mNoiseBuffer;
+		mNoiseGain.Ramp(l, [&](int i, int n, float ng0, float dng)
+		{
+			for(int k = 0; k < n; k ++) pn[i + k] = mNoiseGen.Process() * (ng0 + dng * (float)k);
+		});
+		for(int i = 0; i < l; i ++) po[i] = 0;
+		for(int ib = 0; ib < BandCount; ib ++)
+		{
+			int im = ib - mBandShift;
+			CascadedBPF& bpf = mBPFC[ib];
+			const float* pe = ((0 <= im) && (im < BandCount)) ? (mEnvBuffer + (size_t)im * (size_t)mMaxBlockSize) : nullptr;
+			float nb = NoiseBands[ib];
+			if(pe) { for(int i = 0; i < l; i ++) po[i] += pe[i] * bpf.Process(pc[i] + pn[i] * nb); }
+			else { for(int i = 0; i < l; i ++) bpf.Process(pc[i] + pn[i] * nb); } // keeps the filter running
+		}
 	}
 };
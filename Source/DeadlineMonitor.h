@@ -0,0 +1,168 @@
+//
+//  DeadlineMonitor.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "ProcessProfiler.h"
+#include "FABB/SeqLock.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// compares the processing time of every block with its real-time budget, numSamples / sampleRate
+// enabled by default, define VOCODER_DEADLINE_MONITOR=0 in the project to compile it out
+// the stages are timed by StageLaps, independent of ProcessProfiler, and the breakdown of the worst block is recorded
+#ifndef VOCODER_DEADLINE_MONITOR
+#define VOCODER_DEADLINE_MONITOR 1
+#endif
+
+// the stage breakdown of a block, cheap enough to be always on
+// one timestamp is taken at the end of each stage, and the time since the previous one is charged to the stage,
+// i.e. a few Now() calls per segment, instead of a pair for each ProcessProfiler scope
+// the time between the stages is charged to the next one, except where Skip() is called, e.g. after waiting for the helper thread
+class StageLaps
+{
+public:
+	std::array<uint64_t, ProfileStage::Count> mTimes; // in nanoseconds
+	uint64_t mStart, mLast;
+	StageLaps()
+	{
+		mTimes.fill(0);
+		mStart = mLast = 0;
+	}
+	void Begin()
+	{
+		mTimes.fill(0);
+		mStart = mLast = ProcessProfiler::Now();
+	}
+	// ends the stage
+	void Lap(int stage)
+	{
+		uint64_t t = ProcessProfiler::Now();
+		mTimes[stage] += t - mLast;
+		mLast = t;
+	}
+	// restarts the lap without charging the time to any stage
+	void Skip()
+	{
+		mLast = ProcessProfiler::Now();
+	}
+	// for a stage timed on its own, e.g. on the helper thread, ordered by the dispatch and the join
+	void Add(int stage, uint64_t ns)
+	{
+		mTimes[stage] += ns;
+	}
+	// returns the block total
+	uint64_t End()
+	{
+		mTimes[ProfileStage::Total] = ProcessProfiler::Now() - mStart;
+		return mTimes[ProfileStage::Total];
+	}
+	// ends the stage at the end of the scope
+	class Scope
+	{
+	public:
+		StageLaps& mLaps;
+		int mStage;
+		Scope(StageLaps& l, int stage) : mLaps(l), mStage(stage) {}
+		~Scope() { mLaps.Lap(mStage); }
+	};
+};
+
+#if VOCODER_DEADLINE_MONITOR
+#define VOCODER_LAP_SCOPE(laps, stage) StageLaps::Scope lapScope_##stage(laps, ProfileStage::stage)
+#else
+#define VOCODER_LAP_SCOPE(laps, stage)
+#endif
+
+struct DeadlineStats
+{
+	uint64_t blocks; // since the last reset
+	uint64_t over50, over80, over100; // the blocks that exceeded 50%, 80% and 100% of the budget
+	// the block with the highest load
+	double worstLoad; // elapsed / budget
+	int worstSamples;
+	uint64_t worstElapsed, worstBudget; // in nanoseconds
+	std::array<uint64_t, ProfileStage::Count> worstStages; // in nanoseconds, see StageLaps
+};
+
+// the audio thread updates the statistics and publishes a snapshot at every block,
+// the other threads read the snapshot without locking
+class DeadlineMonitor
+{
+public:
+	DeadlineStats mStats; // owned by the audio thread
+	FABB::SeqLockT<DeadlineStats> mPublished;
+	std::atomic<bool> mResetRequest;
+	double mSampleRate;
+	DeadlineMonitor()
+	{
+		mSampleRate = 44100;
+		mResetRequest = false;
+		mStats = {};
+		mPublished.Store(mStats);
+	}
+	void Prepare(double fs)
+	{
+		mSampleRate = fs;
+	}
+	// can be called from any thread, the statistics are cleared by the audio thread at the next block
+	void RequestReset()
+	{
+		mResetRequest.store(true, std::memory_order_relaxed);
+	}
+	// called on the audio thread at the block end, elapsed is the processing time of the block in nanoseconds
+	// stages: the breakdown of the block by StageLaps, or nullptr when the stages are not timed
+	void Process(int numSamples, uint64_t elapsed, const std::array<uint64_t, ProfileStage::Count>* stages = nullptr)
+	{
+		if(mResetRequest.exchange(false, std::memory_order_relaxed)) mStats = {};
+		if((numSamples <= 0) || (mSampleRate <= 0)) return;
+		uint64_t budget = (uint64_t)((double)numSamples * 1e9 / mSampleRate);
+		double load = (double)elapsed / (double)budget;
+		mStats.blocks ++;
+		if(0.5 < load) mStats.over50 ++;
+		if(0.8 < load) mStats.over80 ++;
+		if(1.0 < load) mStats.over100 ++;
+		if(mStats.worstLoad < load)
+		{
+			mStats.worstLoad = load;
+			mStats.worstSamples = numSamples;
+			mStats.worstElapsed = elapsed;
+			mStats.worstBudget = budget;
+			if(stages) mStats.worstStages = *stages;
+			else mStats.worstStages.fill(0);
+			mStats.worstStages[ProfileStage::Total] = elapsed;
+		}
+		mPublished.Store(mStats);
+	}
+	// can be called from any thread
+	void GetStats(DeadlineStats* pv) const
+	{
+		mPublished.Load(pv);
+	}
+	static std::string ToJSON(const DeadlineStats& st)
+	{
+		char buf[256];
+		std::string s;
+		std::snprintf(buf, sizeof(buf), "{\"blocks\":%llu,\"over50\":%llu,\"over80\":%llu,\"over100\":%llu,",
+			(unsigned long long)st.blocks, (unsigned long long)st.over50, (unsigned long long)st.over80, (unsigned long long)st.over100);
+		s += buf;
+		std::snprintf(buf, sizeof(buf), "\"worst\":{\"load\":%.4f,\"samples\":%d,\"elapsedUs\":%.3f,\"budgetUs\":%.3f,\"stagesUs\":{",
+			st.worstLoad, st.worstSamples, (double)st.worstElapsed * 1e-3, (double)st.worstBudget * 1e-3);
+		s += buf;
+		for(int i = 0; i < ProfileStage::Count; i ++)
+		{
+			std::snprintf(buf, sizeof(buf), "%s\"%s\":%.3f", (0 < i) ? "," : "", ProfileStage::Name(i), (double)st.worstStages[i] * 1e-3);
+			s += buf;
+		}
+		s += "}}}";
+		return s;
+	}
+};
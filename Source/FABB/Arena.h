@@ -0,0 +1,73 @@
+//
+//  Arena.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+namespace FABB
+{
+
+	// one contiguous block of memory, carved into the cache line aligned work buffers by a bump pointer
+	// Reserve() allocates, and should be called outside of the audio thread, e.g. in prepareToPlay
+	// the allocations are released all at once by the next Reserve() or the destruction, so that the pointers stay valid until then
+	// for the trivial types only, the buffers are zero-filled
+	class Arena
+	{
+	public:
+		enum { Alignment = 64 };
+		std::unique_ptr<uint8_t[]> mStorage;
+		uint8_t* mBase;
+		size_t mSize, mUsed;
+		Arena() : mBase(nullptr), mSize(0), mUsed(0)
+		{
+		}
+		static constexpr size_t AlignUp(size_t v)
+		{
+			return (v + (Alignment - 1)) & ~(size_t)(Alignment - 1);
+		}
+		// the bytes needed by Allocate<T>(count)
+		template<typename T> static constexpr size_t Footprint(size_t count)
+		{
+			return AlignUp(sizeof(T) * count);
+		}
+		// discards the previous allocations
+		void Reserve(size_t bytes)
+		{
+			mUsed = 0;
+			if(bytes <= mSize) return;
+			mStorage.reset(new uint8_t[bytes + Alignment]);
+			mBase = (uint8_t*)AlignUp((size_t)(uintptr_t)mStorage.get());
+			mSize = bytes;
+		}
+		// returns nullptr when the reserved space is exhausted
+		template<typename T> T* Allocate(size_t count)
+		{
+			static_assert(std::is_trivial<T>::value, "Arena supports the trivial types only");
+			size_t bytes = Footprint<T>(count);
+			if(mSize < (mUsed + bytes)) return nullptr;
+			T* p = (T*)(mBase + mUsed);
+			std::memset(p, 0, bytes);
+			mUsed += bytes;
+			return p;
+		}
+		size_t GetSize() const
+		{
+			return mSize;
+		}
+		size_t GetUsed() const
+		{
+			return mUsed;
+		}
+	};
+
+} // namespace FABB
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cmath>
+#include "FastMath.h"
 #include "IIR.h"
 
 namespace FABB
@@ -34,7 +35,7 @@ namespace FABB
 		void InternalUpdate()
 		{
 			TBaseIIR* p = (TBaseIIR*)this;
-			TBaseIIR::Coef& coef = p->mCoef;
+			typename TBaseIIR::Coef& coef = p->mCoef;
 			/*
 			DC1z=(z-1)/(z-R);
 			a0=1;
@@ -66,7 +67,7 @@ namespace FABB
 	// H(z) = ------------ = ---------
 	//         1 + a1*z~-1      z + a1
 	//
-	template<typename T, class TBaseIIR> class Analog1FilterT : public TBaseIIR
+	template<typename T, class TBaseIIR, class TMath = MathPolicyDefault> class Analog1FilterT : public TBaseIIR
 	{
 	public:
 		enum Type { LP, HP, AP } mType;
@@ -74,8 +75,8 @@ namespace FABB
 		void InternalUpdate()
 		{
 			TBaseIIR* p = (TBaseIIR*)this;
-			TBaseIIR::Coef& coef = p->mCoef;
-			T w = AFConst::TwoPi<T>() * mFreq, c = std::cos(w), s = std::sin(w);
+			typename TBaseIIR::Coef& coef = p->mCoef;
+			T w = AFConst::TwoPi<T>() * mFreq, c = TMath::Cos(w), s = TMath::Sin(w);
 			T a0, rcpa0;
 			switch(mType)
 			{
@@ -165,7 +166,7 @@ namespace FABB
 	//   BPF   : constant peak gain, peak gain = 1
 	//   BPFVPG: constant skirt gain, peak gain = Q
 	//
-	template<typename T, class TBaseIIR> class RBJFilterT : public TBaseIIR
+	template<typename T, class TBaseIIR, class TMath = MathPolicyDefault> class RBJFilterT : public TBaseIIR
 	{
 	public:
 		enum Type { LP, HP, BP, BPVPG, BR, AP } mType;
@@ -174,8 +175,8 @@ namespace FABB
 		void InternalUpdate()
 		{
 			TBaseIIR* p = (TBaseIIR*)this;
-			TBaseIIR::Coef& coef = p->mCoef;
-			T w = AFConst::TwoPi<T>() * mFreq, c = std::cos(w), s = std::sin(w);
+			typename TBaseIIR::Coef& coef = p->mCoef;
+			T w = AFConst::TwoPi<T>() * mFreq, c = TMath::Cos(w), s = TMath::Sin(w);
 			T a0, rcpa0;
 			switch(mType)
 			{
@@ -298,7 +299,7 @@ namespace FABB
 	//   BPF   : constant peak gain, peak gain = 1
 	//   BPFVPG: constant skirt gain, peak gain = Q
 	//
-	template<typename T, class TBaseIIR> class RBJAFilterT : public TBaseIIR
+	template<typename T, class TBaseIIR, class TMath = MathPolicyDefault> class RBJAFilterT : public TBaseIIR
 	{
 	public:
 		enum Type { LP, HP, BP, BPVPG, BR, AP, PE, LS, HS } mType;
@@ -308,8 +309,8 @@ namespace FABB
 		void InternalUpdate()
 		{
 			TBaseIIR* p = (TBaseIIR*)this;
-			TBaseIIR::Coef& coef = p->mCoef;
-			T w = AFConst::TwoPi<T>() * mFreq, c = std::cos(w), s = std::sin(w);
+			typename TBaseIIR::Coef& coef = p->mCoef;
+			T w = AFConst::TwoPi<T>() * mFreq, c = TMath::Cos(w), s = TMath::Sin(w);
 			T a0, rcpa0;
 			switch(mType)
 			{
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cmath>
+#include "FastMath.h"
 
 namespace FABB
 {
@@ -20,7 +21,7 @@ namespace FABB
 	//   x: sample number ranging from 1 to period
 	//   p: period in samples (fs/f0)
 	//   m=2*((int)p/2)+1 (i.e. when p=odd, m=p otherwise m=p+1)
-	template<typename T> class BlitOscillatorT
+	template<typename T, class TMath = MathPolicyDefault> class BlitOscillatorT
 	{
 	public:
 		static constexpr T PI() { return (T)3.14159265358979323846; }
@@ -46,7 +47,7 @@ namespace FABB
 		}
 		T Process()
 		{
-			T v = mRcpM * ((EPS() < mXxF) ? (std::sin(PI() * mM * mXxF) / std::sin(PI() * mXxF)) : 1);
+			T v = mRcpM * ((EPS() < mXxF) ? (TMath::Sin(PI() * mM * mXxF) / TMath::Sin(PI() * mXxF)) : 1);
 			mXxF += mFreq;
 			if(2 <= mXxF) mXxF -= 2;
 			return v;
@@ -60,4 +61,98 @@ namespace FABB
 	using BlitOscillatorF = BlitOscillatorT<float>;
 	using BlitOscillatorD = BlitOscillatorT<double>;
 
+	// a bank of up to N BLIT oscillators, laid out as struct-of-arrays
+	// when TMath is vectorizable for T (MathPolicyFast for float), the lanes are processed in the groups of 4 lanes with a fixed trip count,
+	// and the active count is rounded up to a whole group, so that each group is computed as one SIMD vector
+	// otherwise std::sin is called for each lane anyway, and only the active lanes are processed one by one
+	template<typename T, int N, class TMath = MathPolicyDefault> class BlitOscillatorBankT
+	{
+	public:
+		static constexpr T PI() { return (T)3.14159265358979323846; }
+		static constexpr T EPS() { return (T)1.192092896e-07; }
+		enum { NumLanes = N, GroupSize = !TMath::template Vectorizable<T>() ? 1 : ((N < 4) ? N : 4) };
+		static_assert((N % GroupSize) == 0, "N must be a multiple of GroupSize");
+		alignas(32) T mFreq[N];
+		alignas(32) T mM[N];
+		alignas(32) T mRcpM[N];
+		alignas(32) T mXxF[N]; // x/p=x*freq
+		int mCount;
+		int mGroups; // mCount rounded up to the groups
+		BlitOscillatorBankT()
+		{
+			mCount = N;
+			mGroups = N / GroupSize;
+			for(int i = 0; i < N; i ++) SetFreq(i, (T)0.001);
+			Reset();
+		}
+		void SetCount(int v)
+		{
+			mCount = (v < 1) ? 1 : ((N < v) ? N : v);
+			mGroups = (mCount + GroupSize - 1) / GroupSize;
+		}
+		int GetCount() const
+		{
+			return mCount;
+		}
+		void SetFreq(int i, T v)
+		{
+			mFreq[i] = v;
+			T p = 1 / mFreq[i];
+			mM[i] = 2 * (T)((int)p / 2) + 1;
+			mRcpM[i] = 1 / mM[i];
+		}
+		// sets the frequency of each lane as (fbase * ratios[i]), including the idle lanes in the last group
+		void SetFreqs(T fbase, const T* ratios)
+		{
+			for(int c = mGroups * GroupSize, i = 0; i < c; i ++)
+			{
+				T f = fbase * ratios[i];
+				T p = 1 / f;
+				mFreq[i] = f;
+				mM[i] = 2 * (T)((int)p / 2) + 1;
+				mRcpM[i] = 1 / mM[i];
+			}
+		}
+		// staggers the initial phases so that the lanes don't start coherently, the lane 0 always starts at zero
+		void Reset()
+		{
+			for(int i = 0; i < N; i ++) mXxF[i] = (T)2 * (T)i / (T)N;
+		}
+		// writes one sample for each lane of the active groups, the lanes from GetCount() are to be ignored
+		// a single lane is processed alone, as a whole group costs more than it
+		void Process(T* po)
+		{
+			if(mCount == 1)
+			{
+				po[0] = internalProcessLane(0);
+				return;
+			}
+			for(int g = 0; g < mGroups; g ++)
+			{
+				int i0 = g * GroupSize;
+				alignas(32) T v[GroupSize]; // a local, so that the lane loop needs no alias check against po
+				for(int i = 0; i < GroupSize; i ++) v[i] = internalProcessLane(i0 + i);
+				for(int i = 0; i < GroupSize; i ++) po[i0 + i] = v[i];
+			}
+		}
+		// for the internal use
+		// the conditions are taken by the integer truncation and blended as 0/1 factors,
+		// as the float compares are not if-converted under the default -ftrapping-math
+		// the blends are exact, and the results equal to BlitOscillatorT except at x=EPS exactly
+		T internalProcessLane(int i)
+		{
+			T x = mXxF[i];
+			T nz = (T)(((int)(x * (1 / EPS())) != 0) ? 1 : 0); // EPS <= x, x=[0~2)
+			T d = TMath::Sin(PI() * x);
+			T n = TMath::Sin(PI() * mM[i] * x);
+			T v = mRcpM[i] * ((n * nz + (1 - nz)) / (d * nz + (1 - nz)));
+			x += mFreq[i];
+			mXxF[i] = x - 2 * (T)(int)(x * (T)0.5); // x=[0~4)
+			return v;
+		}
+	};
+
+	template<int N> using BlitOscillatorBankF = BlitOscillatorBankT<float, N>;
+	template<int N> using BlitOscillatorBankD = BlitOscillatorBankT<double, N>;
+
 } // namespace FABB
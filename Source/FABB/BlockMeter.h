@@ -0,0 +1,83 @@
+//
+//  BlockMeter.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cmath>
+
+namespace FABB
+{
+
+	// level meter ballistics evaluated once per block, fed by a block statistic such as the peak or the RMS
+	// the value approaches the input with the attack or the release time-constant, in closed form over the block length,
+	// and optionally holds the maximum for mHoldTime before releasing
+	// the time-constants and the hold time are in samples, zero makes the move immediate
+	template<typename T> class BlockMeterT
+	{
+	public:
+		T mAttackTC, mReleaseTC, mHoldTime;
+		T mValue;
+		T mHoldCount;
+		// the coefficients for mCoefLength, recalculated when the block length changes
+		int mCoefLength;
+		T mAttackCoef, mReleaseCoef;
+		BlockMeterT()
+		{
+			mAttackTC = mReleaseTC = mHoldTime = 0;
+			mCoefLength = 0;
+			mAttackCoef = mReleaseCoef = 0;
+			Reset();
+		}
+		void SetAttackTC(T v)
+		{
+			mAttackTC = v;
+			mCoefLength = 0;
+		}
+		void SetReleaseTC(T v)
+		{
+			mReleaseTC = v;
+			mCoefLength = 0;
+		}
+		void SetHoldTime(T v)
+		{
+			mHoldTime = v;
+		}
+		void Reset()
+		{
+			mValue = 0;
+			mHoldCount = 0;
+		}
+		T GetValue() const
+		{
+			return mValue;
+		}
+		// v: the statistic of the block, l: the block length
+		T Process(T v, int l)
+		{
+			if(l <= 0) return mValue;
+			if(l != mCoefLength)
+			{
+				mAttackCoef = (0 < mAttackTC) ? std::exp(-(T)l / mAttackTC) : (T)0;
+				mReleaseCoef = (0 < mReleaseTC) ? std::exp(-(T)l / mReleaseTC) : (T)0;
+				mCoefLength = l;
+			}
+			if(mValue <= v)
+			{
+				mValue = v + (mValue - v) * mAttackCoef;
+				mHoldCount = mHoldTime;
+			}
+			else if(0 < mHoldCount) mHoldCount -= (T)l;
+			else mValue = v + (mValue - v) * mReleaseCoef;
+			return mValue;
+		}
+	};
+
+	using BlockMeterF = BlockMeterT<float>;
+	using BlockMeterD = BlockMeterT<double>;
+
+} // namespace FABB
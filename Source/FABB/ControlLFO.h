@@ -0,0 +1,150 @@
+//
+//  ControlLFO.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cmath>
+
+namespace FABB
+{
+
+	// control-rate low frequency oscillator
+	// the waveform is evaluated once per sub-block (the 'node'), and the samples between the nodes are linearly interpolated
+	// the sine shape is generated by a recursive quadrature oscillator, which costs no trigonometric function per node
+	// the output ranges [-1~1], and every shape starts at zero and rises at phase 0:
+	//   Sine    : sin(2*PI*phase)
+	//   Triangle: 0 -> 1 -> -1 -> 0
+	//   SawUp   : 0 -> 1, -1 -> 0
+	//   SawDown : 0 -> -1, 1 -> 0
+	//   Square  : 1, -1
+	// the linear interpolation error of the sine shape is about (2*PI*freq*blocksize)^2/8,
+	// e.g. 0.65% of the amplitude at freq=100Hz, fs=44.1kHz, blocksize=16
+	template<typename T> class ControlLFOT
+	{
+	public:
+		static constexpr T TWOPI() { return (T)6.283185307179586476925286766559; }
+		enum Shape { Sine, Triangle, SawUp, SawDown, Square };
+		enum { DefaultBlockSize = 16 };
+		Shape mShape;
+		int mBlockSize;
+		T mFreq; // in cycles per sample
+		T mPhase; // [0~1], phase at the next node
+		T mCos, mSin; // quadrature state at the next node
+		T mRotCos, mRotSin; // rotation per node
+		T mValue, mDelta;
+		int mCount; // remaining samples until the next node
+		ControlLFOT()
+		{
+			mShape = Sine;
+			mBlockSize = DefaultBlockSize;
+			SetFreq((T)0.0001);
+			Reset();
+		}
+		void SetShape(Shape v)
+		{
+			mShape = v;
+			internalSyncQuadrature();
+		}
+		void SetBlockSize(int v)
+		{
+			mBlockSize = (v < 1) ? 1 : v;
+			internalUpdateRotation();
+		}
+		void SetFreq(T v)
+		{
+			mFreq = v;
+			internalUpdateRotation();
+		}
+		void Reset()
+		{
+			mPhase = 0;
+			internalSyncQuadrature();
+			mValue = 0;
+			mDelta = 0;
+			mCount = 0;
+		}
+		T GetValue() const
+		{
+			return mValue;
+		}
+		T Process()
+		{
+			if(mCount <= 0) internalNextNode();
+			T v = mValue;
+			mValue += mDelta;
+			mCount --;
+			return v;
+		}
+		void Process(T* p, size_t l)
+		{
+			while(0 < l)
+			{
+				if(mCount <= 0) internalNextNode();
+				size_t n = ((size_t)mCount < l) ? (size_t)mCount : l;
+				T v = mValue, d = mDelta;
+				for(size_t i = 0; i < n; i ++) { *p ++ = v; v += d; }
+				mValue = v;
+				mCount -= (int)n;
+				l -= n;
+			}
+		}
+		// for the internal use
+		void internalUpdateRotation()
+		{
+			T w = TWOPI() * mFreq * (T)mBlockSize;
+			mRotCos = std::cos(w);
+			mRotSin = std::sin(w);
+		}
+		void internalSyncQuadrature()
+		{
+			mCos = std::cos(TWOPI() * mPhase);
+			mSin = std::sin(TWOPI() * mPhase);
+		}
+		T internalShapeValue() const
+		{
+			T p = mPhase;
+			switch(mShape)
+			{
+				case Sine: return mSin;
+				case Triangle: return (p < (T)0.25) ? (4 * p) : ((p < (T)0.75) ? (2 - 4 * p) : (4 * p - 4));
+				case SawUp: return (p < (T)0.5) ? (2 * p) : (2 * p - 2);
+				case SawDown: return (p < (T)0.5) ? (-2 * p) : (2 - 2 * p);
+				case Square: return (p < (T)0.5) ? (T)1 : (T)-1;
+			}
+			return 0;
+		}
+		void internalNextNode()
+		{
+			T v0 = internalShapeValue();
+			// advance to the next node
+			mPhase += mFreq * (T)mBlockSize;
+			if(1 <= mPhase)
+			{
+				// re-synchronize the quadrature once per cycle to cancel the accumulated rounding errors
+				mPhase -= std::floor(mPhase);
+				internalSyncQuadrature();
+			}
+			else
+			{
+				T c = mCos * mRotCos - mSin * mRotSin;
+				T s = mSin * mRotCos + mCos * mRotSin;
+				T g = (T)1.5 - (T)0.5 * (c * c + s * s); // keeps the magnitude at unity
+				mCos = c * g;
+				mSin = s * g;
+			}
+			T v1 = internalShapeValue();
+			mValue = v0;
+			mDelta = (v1 - v0) / (T)mBlockSize;
+			mCount = mBlockSize;
+		}
+	};
+
+	using ControlLFOF = ControlLFOT<float>;
+	using ControlLFOD = ControlLFOT<double>;
+
+} // namespace FABB
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <cmath>
+#include "FastMath.h"
 
 namespace FABB
 {
@@ -25,7 +26,7 @@ namespace FABB
 		T Unmap(T v) const { return mAo + (v - mBo) * mAr * mRcpBr; }
 	};
 
-	template<typename T> class CurveMapExponential
+	template<typename T, class TMath = MathPolicyDefault> class CurveMapExponential
 	{
 	protected:
 		T mAo, mAr, mPw, mSc;
@@ -33,8 +34,8 @@ namespace FABB
 	public:
 		CurveMapExponential(T al = (T)0, T ah = (T)1, T bl = (T)0.001, T bh = (T)1) { Setup(al, ah, bl, bh); }
 		void Setup(T al, T ah, T bl, T bh) { mAo = al; mAr = ah - al; mPw = std::log(bh) - std::log(bl); mSc = bl; mRcpAr = 1 / mAr; mRcpPw = 1 / mPw; mRcpSc = 1 / mSc; }
-		T Map(T v) const { return std::exp((v - mAo) * mRcpAr * mPw) * mSc; }
-		T Unmap(T v) const { return mAo + mAr * std::log(v * mRcpSc) * mRcpPw; }
+		T Map(T v) const { return TMath::Exp((v - mAo) * mRcpAr * mPw) * mSc; }
+		T Unmap(T v) const { return mAo + mAr * TMath::Log(v * mRcpSc) * mRcpPw; }
 	};
 
 	using CurveMapLinearF = CurveMapLinear<float>;
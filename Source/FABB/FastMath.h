@@ -0,0 +1,193 @@
+//
+//  FastMath.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace FABB
+{
+
+	/*
+	approximations of the elementary functions in single precision
+
+	every function is branch-free, so that the array versions can be auto-vectorized by the compiler
+	the inputs out of the domains are not checked, e.g. Log2(0), Log2(-1) and Sin(1e9) return meaningless values
+
+	function	domain				max error (measured against double precision)
+	Exp2		[-126~127]			relative 2.5e-7
+	Exp			[-87~88]			relative 2.5e-7 for |x|<=1, grows up to 4.0e-6 at the ends by the rounding of x*log2(e)
+	Log2		normal, 0 < x		absolute 1.2e-7 * max(1, |log2(x)|)
+	Log			normal, 0 < x		absolute 1.4e-7 * max(1, |log(x)|)
+	Pow			0 < a				as Exp2 evaluated at y=b*Log2(a), i.e. relative 2.5e-7 + ln(2) * (|b| * (Log2 error) + 6e-8 * |y|)
+	Sin, Cos	|x| <= 8192			absolute 2.5e-7
+	Tan			|x| <= 8192			absolute 2.0e-7 * (1 + |tan(x)|)^2, not relative near the zeros
+	the bounds are checked by Tests/FastMathTest.cpp
+	*/
+	namespace FastMath
+	{
+
+		inline float internalBitsToFloat(int32_t v) { float f; std::memcpy(&f, &v, sizeof(f)); return f; }
+		inline int32_t internalFloatToBits(float v) { int32_t i; std::memcpy(&i, &v, sizeof(i)); return i; }
+		// floor() for the values in the range of int32_t
+		inline int32_t internalFloorInt(float v) { int32_t i = (int32_t)v; return i - ((v < (float)i) ? 1 : 0); }
+
+		// 2^x = 2^i * 2^f, i=round(x), f=[-0.5~0.5]
+		// 2^f is the Taylor series up to the 6th order
+		inline float Exp2(float x)
+		{
+			int32_t i = internalFloorInt(x + 0.5f);
+			// limits the exponent to keep the result finite, the result is meaningless out of the domain anyway
+			i = (i < -126) ? -126 : i;
+			i = (127 < i) ? 127 : i;
+			float f = x - (float)i;
+			float p = 1.540353039338160e-4f;
+			p = p * f + 1.333355814642844e-3f;
+			p = p * f + 9.618129107628477e-3f;
+			p = p * f + 5.550410866482158e-2f;
+			p = p * f + 2.402265069591007e-1f;
+			p = p * f + 6.931471805599453e-1f;
+			p = p * f + 1.0f;
+			return p * internalBitsToFloat((i + 127) << 23);
+		}
+
+		// log2(x) = e + log2(m), m=[sqrt(1/2)~sqrt(2)]
+		// log2(m) = 2/ln(2) * atanh(z), z=(m-1)/(m+1), by the series up to z^9
+		inline float Log2(float x)
+		{
+			int32_t bits = internalFloatToBits(x);
+			int32_t e = ((bits >> 23) & 0xff) - 127;
+			float m = internalBitsToFloat((bits & 0x007fffff) | 0x3f800000);
+			int32_t big = (1.41421356f < m) ? 1 : 0;
+			m *= internalBitsToFloat((127 - big) << 23); // 1 or 0.5
+			e += big;
+			float z = (m - 1.0f) / (m + 1.0f);
+			float z2 = z * z;
+			float p = 0.3205988450774189f; // 2/ln(2)/9
+			p = p * z2 + 0.4121985150995386f; // 2/ln(2)/7
+			p = p * z2 + 0.5770780163555854f; // 2/ln(2)/5
+			p = p * z2 + 0.9617966939259756f; // 2/ln(2)/3
+			p = p * z2 + 2.8853900817779268f; // 2/ln(2)
+			return (float)e + p * z;
+		}
+
+		inline float Exp(float x)
+		{
+			return Exp2(x * 1.4426950408889634f);
+		}
+
+		inline float Log(float x)
+		{
+			return Log2(x) * 0.6931471805599453f;
+		}
+
+		inline float Pow(float a, float b)
+		{
+			return Exp2(b * Log2(a));
+		}
+
+		// sin(r) for r=[-PI/2~PI/2], the Taylor series up to the 11th order, and negated when k is odd
+		inline float internalSinKernel(float r, int32_t k)
+		{
+			float r2 = r * r;
+			float p = -2.505210838544172e-8f;
+			p = p * r2 + 2.755731922398589e-6f;
+			p = p * r2 - 1.984126984126984e-4f;
+			p = p * r2 + 8.333333333333333e-3f;
+			p = p * r2 - 1.666666666666667e-1f;
+			p = p * r2 + 1.0f;
+			float v = p * r;
+			return internalBitsToFloat(internalFloatToBits(v) ^ (int32_t)((uint32_t)(k & 1) << 31));
+		}
+
+		// sin(x) = (-1)^k * sin(r), k=round(x/PI), r=x-k*PI
+		// PI is splitted into 2 parts for the accurate reduction
+		inline float Sin(float x)
+		{
+			int32_t k = internalFloorInt(x * 0.3183098861837907f + 0.5f);
+			float fk = (float)k;
+			float r = (x - fk * 3.140625f) - fk * 9.676535897932385e-4f;
+			return internalSinKernel(r, k);
+		}
+
+		// cos(x) = sin(x+PI/2) = (-1)^k * sin(r), k=floor(x/PI+1), r=x-k*PI+PI/2
+		inline float Cos(float x)
+		{
+			int32_t k = internalFloorInt(x * 0.3183098861837907f + 1.0f);
+			float fk = (float)k;
+			float r = ((x - fk * 3.140625f) - fk * 9.676535897932385e-4f) + 1.5707963267948966f;
+			return internalSinKernel(r, k);
+		}
+
+		inline float Tan(float x)
+		{
+			return Sin(x) / Cos(x);
+		}
+
+		// array versions, allow inplace (po == pi)
+		inline void Exp2(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = Exp2(pi[i]); }
+		inline void Exp(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = Exp(pi[i]); }
+		inline void Log2(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = Log2(pi[i]); }
+		inline void Log(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = Log(pi[i]); }
+		inline void Sin(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = Sin(pi[i]); }
+		inline void Cos(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = Cos(pi[i]); }
+		inline void Tan(const float* pi, float* po, size_t l) { for(size_t i = 0; i < l; i ++) po[i] = Tan(pi[i]); }
+
+	} // namespace FastMath
+
+	//==============================================================================
+	// math policies
+	// the building blocks take a policy as the template parameter to choose the precise or the fast implementation
+
+	// Vectorizable<T>() tells whether the functions for T are inlined branch-free code, which the loops over them can be vectorized with
+	struct MathPolicyPrecise
+	{
+		template<typename T> static constexpr bool Vectorizable() { return false; }
+		template<typename T> static T Exp(T v) { return std::exp(v); }
+		template<typename T> static T Exp2(T v) { return std::exp2(v); }
+		template<typename T> static T Log(T v) { return std::log(v); }
+		template<typename T> static T Log2(T v) { return std::log2(v); }
+		template<typename T> static T Pow(T a, T b) { return std::pow(a, b); }
+		template<typename T> static T Sin(T v) { return std::sin(v); }
+		template<typename T> static T Cos(T v) { return std::cos(v); }
+		template<typename T> static T Tan(T v) { return std::tan(v); }
+	};
+
+	// uses the approximations for float, and falls back to the precise functions for double
+	struct MathPolicyFast
+	{
+		template<typename T> static constexpr bool Vectorizable() { return std::is_same<T, float>::value; }
+		template<typename T> static T Exp(T v) { return std::exp(v); }
+		template<typename T> static T Exp2(T v) { return std::exp2(v); }
+		template<typename T> static T Log(T v) { return std::log(v); }
+		template<typename T> static T Log2(T v) { return std::log2(v); }
+		template<typename T> static T Pow(T a, T b) { return std::pow(a, b); }
+		template<typename T> static T Sin(T v) { return std::sin(v); }
+		template<typename T> static T Cos(T v) { return std::cos(v); }
+		template<typename T> static T Tan(T v) { return std::tan(v); }
+		static float Exp(float v) { return FastMath::Exp(v); }
+		static float Exp2(float v) { return FastMath::Exp2(v); }
+		static float Log(float v) { return FastMath::Log(v); }
+		static float Log2(float v) { return FastMath::Log2(v); }
+		static float Pow(float a, float b) { return FastMath::Pow(a, b); }
+		static float Sin(float v) { return FastMath::Sin(v); }
+		static float Cos(float v) { return FastMath::Cos(v); }
+		static float Tan(float v) { return FastMath::Tan(v); }
+	};
+
+#if defined(FABB_FASTMATH_DEFAULT) && FABB_FASTMATH_DEFAULT
+	using MathPolicyDefault = MathPolicyFast;
+#else
+	using MathPolicyDefault = MathPolicyPrecise;
+#endif
+
+} // namespace FABB
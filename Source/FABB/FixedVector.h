@@ -0,0 +1,67 @@
+//
+//  FixedVector.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace FABB
+{
+
+	// vector with the fixed capacity N and the storage inline, never allocates
+	// a subset of std::vector, push_back() ignores the element and returns false when full
+	template<typename T, size_t N> class FixedVectorT
+	{
+	public:
+		using iterator = T*;
+		using const_iterator = const T*;
+		std::array<T, N> mItems;
+		size_t mCount;
+		FixedVectorT() : mItems(), mCount(0)
+		{
+		}
+		static constexpr size_t capacity() { return N; }
+		size_t size() const { return mCount; }
+		bool empty() const { return mCount == 0; }
+		bool full() const { return mCount == N; }
+		iterator begin() { return mItems.data(); }
+		iterator end() { return mItems.data() + mCount; }
+		const_iterator begin() const { return mItems.data(); }
+		const_iterator end() const { return mItems.data() + mCount; }
+		T& operator[](size_t i) { return mItems[i]; }
+		const T& operator[](size_t i) const { return mItems[i]; }
+		T& front() { return mItems[0]; }
+		const T& front() const { return mItems[0]; }
+		T& back() { return mItems[mCount - 1]; }
+		const T& back() const { return mItems[mCount - 1]; }
+		void clear()
+		{
+			mCount = 0;
+		}
+		bool push_back(const T& v)
+		{
+			if(N <= mCount) return false;
+			mItems[mCount ++] = v;
+			return true;
+		}
+		// keeps the order of the rest, returns the iterator following the removed elements
+		iterator erase(iterator first, iterator last)
+		{
+			iterator d = first;
+			for(iterator s = last; s != end(); ) *d ++ = *s ++;
+			mCount -= (size_t)(last - first);
+			return first;
+		}
+		iterator erase(iterator it)
+		{
+			return erase(it, it + 1);
+		}
+	};
+
+} // namespace FABB
@@ -0,0 +1,118 @@
+//
+//  GainStage.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+namespace FABB
+{
+
+	// gain ramp kernels, the gain at the i-th sample is g0+dg*i, see BlockSmootherT::NextBlock() and GridSmootherT::Ramp()
+	// every kernel is a single pass of independent lanes, so that it can be auto-vectorized by the compiler
+	// the constant gain (dg=0) takes the same path, the cost of the ramp is one multiply-add per sample
+	// the overloads with Stats accumulate the peak and the sum of squares of the output in the same pass
+	namespace GainStage
+	{
+
+		// block statistics, accumulated over the kernel calls until Reset()
+		struct Stats
+		{
+			float peak, sumsq;
+			size_t count;
+			Stats() { Reset(); }
+			void Reset() { peak = 0; sumsq = 0; count = 0; }
+			float RMS() const { return (0 < count) ? std::sqrt(sumsq / (float)count) : 0.0f; }
+		};
+
+		// the statistics are kept in Lanes partial accumulators, since the reductions are not vectorized
+		// unless the compiler is allowed to reorder the floating point operations
+		enum { Lanes = 8 };
+
+		// fn(i) computes and stores the i-th output sample, and returns it
+		template<typename TFn> inline void internalRunStats(size_t l, Stats* ps, TFn fn)
+		{
+			float pk[Lanes] = {}, ss[Lanes] = {};
+			size_t n = l - l % Lanes;
+			for(size_t i = 0; i < n; i += Lanes)
+			{
+				for(size_t k = 0; k < Lanes; k ++)
+				{
+					float v = fn(i + k), a = std::abs(v);
+					pk[k] = (pk[k] < a) ? a : pk[k];
+					ss[k] += v * v;
+				}
+			}
+			for(size_t i = n; i < l; i ++)
+			{
+				float v = fn(i), a = std::abs(v);
+				pk[0] = (pk[0] < a) ? a : pk[0];
+				ss[0] += v * v;
+			}
+			for(size_t k = 0; k < Lanes; k ++)
+			{
+				ps->peak = (ps->peak < pk[k]) ? pk[k] : ps->peak;
+				ps->sumsq += ss[k];
+			}
+			ps->count += l;
+		}
+
+		// p[i] *= g
+		inline void Gain(float* p, size_t l, float g0, float dg)
+		{
+			for(size_t i = 0; i < l; i ++) p[i] *= g0 + dg * (float)i;
+		}
+		inline void Gain(float* p, size_t l, float g0, float dg, Stats* ps)
+		{
+			internalRunStats(l, ps, [=](size_t i) { return p[i] *= g0 + dg * (float)i; });
+		}
+
+		// po[i] = pi[i] * g, allows inplace (po == pi)
+		inline void Gain(const float* pi, float* po, size_t l, float g0, float dg)
+		{
+			for(size_t i = 0; i < l; i ++) po[i] = pi[i] * (g0 + dg * (float)i);
+		}
+		inline void Gain(const float* pi, float* po, size_t l, float g0, float dg, Stats* ps)
+		{
+			internalRunStats(l, ps, [=](size_t i) { return po[i] = pi[i] * (g0 + dg * (float)i); });
+		}
+
+		// po[i] = (pa[i] + pb[i]) * g, allows inplace (po == pa or po == pb)
+		inline void SumGain(const float* pa, const float* pb, float* po, size_t l, float g0, float dg)
+		{
+			for(size_t i = 0; i < l; i ++) po[i] = (pa[i] + pb[i]) * (g0 + dg * (float)i);
+		}
+		inline void SumGain(const float* pa, const float* pb, float* po, size_t l, float g0, float dg, Stats* ps)
+		{
+			internalRunStats(l, ps, [=](size_t i) { return po[i] = (pa[i] + pb[i]) * (g0 + dg * (float)i); });
+		}
+
+		// po[i] = (pa[i] + pb[i] + pc[i]) * g, allows inplace (po == pa, pb or pc)
+		inline void SumGain(const float* pa, const float* pb, const float* pc, float* po, size_t l, float g0, float dg)
+		{
+			for(size_t i = 0; i < l; i ++) po[i] = (pa[i] + pb[i] + pc[i]) * (g0 + dg * (float)i);
+		}
+		inline void SumGain(const float* pa, const float* pb, const float* pc, float* po, size_t l, float g0, float dg, Stats* ps)
+		{
+			internalRunStats(l, ps, [=](size_t i) { return po[i] = (pa[i] + pb[i] + pc[i]) * (g0 + dg * (float)i); });
+		}
+
+		// po0[i] = po1[i] = pi[i] * g, allows inplace (po0 == pi)
+		inline void GainFanOut(const float* pi, float* po0, float* po1, size_t l, float g0, float dg)
+		{
+			for(size_t i = 0; i < l; i ++) { float v = pi[i] * (g0 + dg * (float)i); po0[i] = v; po1[i] = v; }
+		}
+		inline void GainFanOut(const float* pi, float* po0, float* po1, size_t l, float g0, float dg, Stats* ps)
+		{
+			internalRunStats(l, ps, [=](size_t i) { float v = pi[i] * (g0 + dg * (float)i); po0[i] = v; po1[i] = v; return v; });
+		}
+
+	} // namespace GainStage
+
+} // namespace FABB
@@ -10,8 +10,10 @@
 #include <cctype>
 #include <cmath>
 #include <cstdlib>
-#include <list>
+#include <cstring>
+#include <limits>
 #include <string>
+#include <vector>
 #include "MathExpression.h"
 
 namespace FABB
@@ -19,8 +21,8 @@ namespace FABB
 	namespace MathExpression
 	{
 
-		static inline int CHARS(int ch) { return ch; }
-		static inline int CHARS(int ch1, int ch2) { return (ch1 << 8) | ch2; }
+		static constexpr int CHARS(int ch) { return ch; }
+		static constexpr int CHARS(int ch1, int ch2) { return (ch1 << 8) | ch2; }
 		static inline const char* skipblank(const char* p) { while(isspace(*p)) p ++; return p; }
 		static inline const char* skipalnum(const char* p) { while(isalnum(*p)) p ++; return p; }
 
@@ -61,165 +63,267 @@ namespace FABB
 			return nullptr;
 		}
 
-		static std::string strlower(const std::string& s)
+		// the bytecode operates on a value stack
+		enum Opcode
 		{
-			std::string sr = s;
-			std::for_each(sr.begin(), sr.end(), [](char& c) { c = (char)tolower(c); });
-			return sr;
-		}
-
-		struct Token
-		{
-			union
-			{
-				double value;
-				int opcode;
-			};
-			enum { type_value, type_opcode } type;
-			Token(double v) { value = v; type = type_value; }
-			Token(int c) { opcode = c; type = type_opcode; }
-			bool operator==(double v) const { return (type == type_value) && (value == v); }
-			bool operator==(int c) const { return  (type == type_opcode) && (opcode == c); }
-			bool isvalue() const { return type == type_value; }
-			bool isopcode() const { return type == type_opcode; }
+			// push
+			op_value, op_x,
+			// unary, on the top
+			op_not, op_neg,
+			// binary, pops the right operand
+			op_le, op_lt, op_ge, op_gt, op_eq, op_ne, op_and, op_or, op_add, op_sub, op_mul, op_div, op_mod, op_pow,
+			// functions, on the top
+			op_exp, op_exp2, op_exp10, op_log, op_log2, op_log10, op_cos, op_sin, op_tan, op_acos, op_asin, op_atan,
+			op_cosh, op_sinh, op_tanh, op_acosh, op_asinh, op_atanh, op_sqrt,
 		};
 
-		using TokenList = std::list<Token>;
-
-		static bool getnextopcode(const TokenList& tokens, TokenList::const_iterator& i, int* pv)
+		static int binaryopcode(int op)
 		{
-			if(i == tokens.end() || !i->isopcode()) return false;
-			*pv = i->opcode; i ++; return true;
+			switch(op)
+			{
+				case CHARS('<', '='): return op_le;
+				case CHARS('<'): return op_lt;
+				case CHARS('>', '='): return op_ge;
+				case CHARS('>'): return op_gt;
+				case CHARS('='): return op_eq;
+				case CHARS('!', '='): return op_ne;
+				case CHARS('&'): return op_and;
+				case CHARS('|'): return op_or;
+				case CHARS('+'): return op_add;
+				case CHARS('-'): return op_sub;
+				case CHARS('*'): return op_mul;
+				case CHARS('/'): return op_div;
+				case CHARS('%'): return op_mod;
+				case CHARS('^'): return op_pow;
+			}
+			return -1;
 		}
 
-		static bool getnextvalue(const TokenList& tokens, TokenList::const_iterator& i, double* pv)
+		static int functionopcode(const char* p, size_t l)
 		{
-			if(i == tokens.end()) return false;
-			if(i->isopcode())
+			static const struct { const char* tag; int opcode; } Functions[] =
+			{
+				{ "exp", op_exp }, { "exp2", op_exp2 }, { "exp10", op_exp10 }, { "log", op_log }, { "log2", op_log2 }, { "log10", op_log10 },
+				{ "cos", op_cos }, { "sin", op_sin }, { "tan", op_tan }, { "acos", op_acos }, { "asin", op_asin }, { "atan", op_atan },
+				{ "cosh", op_cosh }, { "sinh", op_sinh }, { "tanh", op_tanh }, { "acosh", op_acosh }, { "asinh", op_asinh }, { "atanh", op_atanh },
+				{ "sqrt", op_sqrt },
+			};
+			for(const auto& f : Functions)
 			{
-				// process unary operators
-				int op = i->opcode; i ++;
-				if(i == tokens.end() || !i->isvalue()) return false;
-				if(op == CHARS('!')) { *pv = (i->value == 0) ? 1 : 0; i ++; return true; }
-				if(op == CHARS('-')) { *pv = -i->value; i ++; return true; }
-				else return false;
+				if(strlen(f.tag) != l) continue;
+				size_t i = 0; while((i < l) && (f.tag[i] == tolower(p[i]))) i ++;
+				if(i == l) return f.opcode;
 			}
-			else { *pv = i->value; i ++; return true; }
+			return -1;
 		}
 
-		bool Evaluate(const char* p, double xValue, double* pv, std::string* perr)
+		// compiles the sequence in [p, pe), the operators are applied in order
+		// depth: the stack depth on entry, *pmaxdepth is updated with the deepest level
+		static bool compilesequence(const char* p, const char* pe, int depth, std::vector<Compiled::Instruction>& code, int* pmaxdepth, std::string* perr)
 		{
-			if(!p || !*p) { if(perr) *perr = "invalid parameters"; return false; }
-			// parse tokens
-			TokenList tokens;
-			while(*p)
+			if(p == pe) { if(perr) *perr = "invalid parameters"; return false; }
+			// the sequence errors are reported after the whole sequence has been parsed
+			const char* seqerr = nullptr;
+			bool expectvalue = true, empty = true;
+			int unaryop = 0, binaryop = -1;
+			auto pushvalue = [&](double v, int opcode)
+			{
+				code.push_back({ opcode, v });
+				*pmaxdepth = std::max(*pmaxdepth, depth + ((binaryop < 0) ? 1 : 2));
+			};
+			// applies the pending operators after a value has been pushed
+			auto endvalue = [&]()
+			{
+				empty = false;
+				if(!expectvalue) { if(!seqerr) seqerr = "invalid sequence"; return; }
+				if(unaryop == CHARS('!')) code.push_back({ op_not, 0 });
+				else if(unaryop == CHARS('-')) code.push_back({ op_neg, 0 });
+				if(0 <= binaryop) code.push_back({ binaryop, 0 });
+				unaryop = 0;
+				expectvalue = false;
+			};
+			auto opcode = [&](int op)
+			{
+				empty = false;
+				if(expectvalue)
+				{
+					// unary operators
+					if(unaryop || ((op != CHARS('!')) && (op != CHARS('-')))) { if(!seqerr) seqerr = "invalid sequence"; return; }
+					unaryop = op;
+				}
+				else
+				{
+					binaryop = binaryopcode(op);
+					if(binaryop < 0) { if(!seqerr) seqerr = "invalid sequence"; return; }
+					expectvalue = true;
+				}
+			};
+			// the nested sequence is evaluated on top of the left operand, if any
+			auto nesteddepth = [&]() { return depth + ((binaryop < 0) ? 0 : 1); };
+			while(p < pe)
 			{
 				p = skipblank(p);
-				if(!*p) break;
+				if(pe <= p) break;
 				else if(*p == '(')
 				{
 					const char* ppare = findparenthesisrange(p);
-					if(!ppare) { if(perr) *perr = "parenthesis missmatch"; return false; }
-					double v = 0; if(!Evaluate(std::string(p + 1, ppare - p - 2).c_str(), xValue, &v, perr)) return false;
-					tokens.push_back(Token(v));
+					if(!ppare || (pe < ppare)) { if(perr) *perr = "parenthesis missmatch"; return false; }
+					if(!compilesequence(p + 1, ppare - 1, nesteddepth(), code, pmaxdepth, perr)) return false;
+					endvalue();
 					p = ppare;
 				}
-				else if(strncmp(p, "%epsf", 5) == 0) { tokens.push_back(Token(std::numeric_limits<float>::epsilon()));	p += 5; }
-				else if(strncmp(p, "%epsd", 5) == 0) { tokens.push_back(Token(std::numeric_limits<double>::epsilon()));	p += 5; }
-				else if(strncmp(p, "%eps", 4) == 0) { tokens.push_back(Token(std::numeric_limits<double>::epsilon()));	p += 4; }
-				else if(strncmp(p, "%e", 2) == 0) { tokens.push_back(Token(2.71828182845904523536));	p += 2; }
-				else if(strncmp(p, "%pi", 3) == 0) { tokens.push_back(Token(3.14159265358979323846));	p += 3; }
-				else if(strncmp(p, "<=", 2) == 0) { tokens.push_back(Token(CHARS('<', '=')));			p += 2; }
-				else if(strncmp(p, "<", 1) == 0) { tokens.push_back(Token(CHARS('<')));				p += 1; }
-				else if(strncmp(p, ">=", 2) == 0) { tokens.push_back(Token(CHARS('>', '=')));			p += 2; }
-				else if(strncmp(p, ">", 1) == 0) { tokens.push_back(Token(CHARS('>')));				p += 1; }
-				else if(strncmp(p, "=", 1) == 0) { tokens.push_back(Token(CHARS('=')));				p += 1; }
-				else if(strncmp(p, "!=", 2) == 0) { tokens.push_back(Token(CHARS('!', '=')));			p += 2; }
-				else if(*p == '!') { tokens.push_back(Token(CHARS('!'))); p ++; }
-				else if(*p == '&') { tokens.push_back(Token(CHARS('&'))); p ++; }
-				else if(*p == '|') { tokens.push_back(Token(CHARS('|'))); p ++; }
-				else if(*p == '+') { tokens.push_back(Token(CHARS('+'))); p ++; }
-				else if(*p == '-') { tokens.push_back(Token(CHARS('-'))); p ++; }
-				else if(*p == '*') { tokens.push_back(Token(CHARS('*'))); p ++; }
-				else if(*p == '/') { tokens.push_back(Token(CHARS('/'))); p ++; }
-				else if(*p == '%') { tokens.push_back(Token(CHARS('%'))); p ++; }
-				else if(*p == '^') { tokens.push_back(Token(CHARS('^'))); p ++; }
-				else if(*p == 'x') { tokens.push_back(Token(xValue)); p ++; }
+				else if(strncmp(p, "%epsf", 5) == 0) { pushvalue(std::numeric_limits<float>::epsilon(), op_value); endvalue(); p += 5; }
+				else if(strncmp(p, "%epsd", 5) == 0) { pushvalue(std::numeric_limits<double>::epsilon(), op_value); endvalue(); p += 5; }
+				else if(strncmp(p, "%eps", 4) == 0) { pushvalue(std::numeric_limits<double>::epsilon(), op_value); endvalue(); p += 4; }
+				else if(strncmp(p, "%e", 2) == 0) { pushvalue(2.71828182845904523536, op_value); endvalue(); p += 2; }
+				else if(strncmp(p, "%pi", 3) == 0) { pushvalue(3.14159265358979323846, op_value); endvalue(); p += 3; }
+				else if(strncmp(p, "<=", 2) == 0) { opcode(CHARS('<', '='));	p += 2; }
+				else if(strncmp(p, "<", 1) == 0) { opcode(CHARS('<'));			p += 1; }
+				else if(strncmp(p, ">=", 2) == 0) { opcode(CHARS('>', '='));	p += 2; }
+				else if(strncmp(p, ">", 1) == 0) { opcode(CHARS('>'));			p += 1; }
+				else if(strncmp(p, "=", 1) == 0) { opcode(CHARS('='));			p += 1; }
+				else if(strncmp(p, "!=", 2) == 0) { opcode(CHARS('!', '='));	p += 2; }
+				else if(*p == '!') { opcode(CHARS('!')); p ++; }
+				else if(*p == '&') { opcode(CHARS('&')); p ++; }
+				else if(*p == '|') { opcode(CHARS('|')); p ++; }
+				else if(*p == '+') { opcode(CHARS('+')); p ++; }
+				else if(*p == '-') { opcode(CHARS('-')); p ++; }
+				else if(*p == '*') { opcode(CHARS('*')); p ++; }
+				else if(*p == '/') { opcode(CHARS('/')); p ++; }
+				else if(*p == '%') { opcode(CHARS('%')); p ++; }
+				else if(*p == '^') { opcode(CHARS('^')); p ++; }
+				else if(*p == 'x') { pushvalue(0, op_x); endvalue(); p ++; }
 				else if(isalpha(*p)) // functions
 				{
 					const char* ptage = skipalnum(p);
-					if(!*ptage) { if(perr) *perr = "invalid token"; return false; }
+					if(pe <= ptage) { if(perr) *perr = "invalid token"; return false; }
 					const char* ppar = skipblank(ptage);
 					if(*ppar != '(') { if(perr) *perr = "invalid sequence"; return false; }
 					const char* ppare = findparenthesisrange(ppar);
-					if(!ppare) { if(perr) *perr = "parenthesis missmatch"; return false; }
-					double v = 0; if(!Evaluate(std::string(ppar + 1, ppare - ppar - 2).c_str(), xValue, &v, perr)) return false;
-					std::string tag = strlower(std::string(p, ptage - p));
-					if(tag == "exp") v = std::exp(v);
-					else if(tag == "exp2") v = std::pow(2, v);
-					else if(tag == "exp10") v = std::pow(10, v);
-					else if(tag == "log") v = std::log(v);
-					else if(tag == "log2") v = std::log2(v);
-					else if(tag == "log10") v = std::log10(v);
-					else if(tag == "cos") v = std::cos(v);
-					else if(tag == "sin") v = std::sin(v);
-					else if(tag == "tan") v = std::tan(v);
-					else if(tag == "acos") v = std::acos(v);
-					else if(tag == "asin") v = std::asin(v);
-					else if(tag == "atan") v = std::atan(v);
-					else if(tag == "cosh") v = std::cosh(v);
-					else if(tag == "sinh") v = std::sinh(v);
-					else if(tag == "tanh") v = std::tanh(v);
-					else if(tag == "acosh") v = std::acosh(v);
-					else if(tag == "asinh") v = std::asinh(v);
-					else if(tag == "atanh") v = std::atanh(v);
-					else if(tag == "sqrt") v = std::sqrt(v);
-					else { if(perr) *perr = "invalid token"; return false; }
-					tokens.push_back(Token(v));
+					if(!ppare || (pe < ppare)) { if(perr) *perr = "parenthesis missmatch"; return false; }
+					if(!compilesequence(ppar + 1, ppare - 1, nesteddepth(), code, pmaxdepth, perr)) return false;
+					int fn = functionopcode(p, ptage - p);
+					if(fn < 0) { if(perr) *perr = "invalid token"; return false; }
+					code.push_back({ fn, 0 });
+					endvalue();
 					p = ppare;
 				}
 				else // real values
 				{
 					char* pn = nullptr; double v = std::strtod(p, &pn);
 					if(pn == p) { if(perr) *perr = "invalid token"; return false; }
-					tokens.push_back(Token(v));
+					pushvalue(v, op_value);
+					endvalue();
 					p = pn;
 				}
 			}
-			if(tokens.empty()) return false;
-			// process tokens
-			// first value
-			TokenList::const_iterator i = tokens.begin();
-			double vr = 0; if(!getnextvalue(tokens, i, &vr)) { if(perr) *perr = "invalid sequence"; return false; }
-			// next binary operator and value pair
-			while(i != tokens.end())
+			if(empty) return false;
+			if(!seqerr && expectvalue) seqerr = "invalid sequence";
+			if(seqerr) { if(perr) *perr = seqerr; return false; }
+			return true;
+		}
+
+		Compiled::Compiled()
+		{
+		}
+
+		Compiled::Compiled(const char* p, std::string* perr)
+		{
+			Compile(p, perr);
+		}
+
+		bool Compiled::Compile(const char* p, std::string* perr)
+		{
+			Clear();
+			if(!p || !*p) { if(perr) *perr = "invalid parameters"; return false; }
+			int maxdepth = 0;
+			if(!compilesequence(p, p + strlen(p), 0, mCode, &maxdepth, perr)) { Clear(); return false; }
+			if(MaxStackDepth < maxdepth) { if(perr) *perr = "too deeply nested"; Clear(); return false; }
+			mCode.shrink_to_fit();
+			return true;
+		}
+
+		void Compiled::Clear()
+		{
+			mCode.clear();
+		}
+
+		bool Compiled::IsValid() const
+		{
+			return !mCode.empty();
+		}
+
+		bool Compiled::Evaluate(double xValue, double* pv) const
+		{
+			if(mCode.empty()) return false;
+			double stack[MaxStackDepth];
+			int sp = 0;
+			for(const Instruction& ins : mCode)
 			{
-				// process binary operators
-				int op = 0; if(!getnextopcode(tokens, i, &op)) { if(perr) *perr = "invalid sequence"; return false; }
-				double vn = 0; if(!getnextvalue(tokens, i, &vn)) { if(perr) *perr = "invalid sequence"; return false; }
-				if(op == CHARS('<', '=')) vr = (vr <= vn) ? 1 : 0;
-				else if(op == CHARS('<')) vr = (vr < vn) ? 1 : 0;
-				else if(op == CHARS('>', '=')) vr = (vr >= vn) ? 1 : 0;
-				else if(op == CHARS('>')) vr = (vr > vn) ? 1 : 0;
-				else if(op == CHARS('=')) vr = (vr == vn) ? 1 : 0;
-				else if(op == CHARS('!', '=')) vr = (vr != vn) ? 1 : 0;
-				else if(op == CHARS('&')) vr = (vr && vn) ? 1 : 0;
-				else if(op == CHARS('|')) vr = (vr || vn) ? 1 : 0;
-				else if(op == CHARS('+')) vr += vn;
-				else if(op == CHARS('-')) vr -= vn;
-				else if(op == CHARS('*')) vr = safemul(vr, vn);
-				else if(op == CHARS('/')) vr = safediv(vr, vn);
-				else if(op == CHARS('%')) vr = std::fmod(vr, vn);
-				else if(op == CHARS('^')) vr = std::pow(vr, vn);
-				else { if(perr) *perr = "invalid sequence"; return false; }
+				double& vt = stack[(0 < sp) ? (sp - 1) : 0];
+				double& vl = stack[(1 < sp) ? (sp - 2) : 0];
+				switch(ins.opcode)
+				{
+					case op_value: stack[sp ++] = ins.value; break;
+					case op_x: stack[sp ++] = xValue; break;
+					case op_not: vt = (vt == 0) ? 1 : 0; break;
+					case op_neg: vt = -vt; break;
+					case op_le: vl = (vl <= vt) ? 1 : 0; sp --; break;
+					case op_lt: vl = (vl < vt) ? 1 : 0; sp --; break;
+					case op_ge: vl = (vl >= vt) ? 1 : 0; sp --; break;
+					case op_gt: vl = (vl > vt) ? 1 : 0; sp --; break;
+					case op_eq: vl = (vl == vt) ? 1 : 0; sp --; break;
+					case op_ne: vl = (vl != vt) ? 1 : 0; sp --; break;
+					case op_and: vl = (vl && vt) ? 1 : 0; sp --; break;
+					case op_or: vl = (vl || vt) ? 1 : 0; sp --; break;
+					case op_add: vl += vt; sp --; break;
+					case op_sub: vl -= vt; sp --; break;
+					case op_mul: vl = safemul(vl, vt); sp --; break;
+					case op_div: vl = safediv(vl, vt); sp --; break;
+					case op_mod: vl = std::fmod(vl, vt); sp --; break;
+					case op_pow: vl = std::pow(vl, vt); sp --; break;
+					case op_exp: vt = std::exp(vt); break;
+					case op_exp2: vt = std::pow(2, vt); break;
+					case op_exp10: vt = std::pow(10, vt); break;
+					case op_log: vt = std::log(vt); break;
+					case op_log2: vt = std::log2(vt); break;
+					case op_log10: vt = std::log10(vt); break;
+					case op_cos: vt = std::cos(vt); break;
+					case op_sin: vt = std::sin(vt); break;
+					case op_tan: vt = std::tan(vt); break;
+					case op_acos: vt = std::acos(vt); break;
+					case op_asin: vt = std::asin(vt); break;
+					case op_atan: vt = std::atan(vt); break;
+					case op_cosh: vt = std::cosh(vt); break;
+					case op_sinh: vt = std::sinh(vt); break;
+					case op_tanh: vt = std::tanh(vt); break;
+					case op_acosh: vt = std::acosh(vt); break;
+					case op_asinh: vt = std::asinh(vt); break;
+					case op_atanh: vt = std::atanh(vt); break;
+					case op_sqrt: vt = std::sqrt(vt); break;
+				}
 			}
-			*pv = vr;
+			*pv = stack[0];
 			return true;
 		}
 
+		bool Compiled::Evaluate(float xValue, float* pv) const
+		{
+			double vo = 0; if(!Evaluate((double)xValue, &vo)) return false;
+			*pv = (float)vo;
+			return true;
+		}
+
+		bool Evaluate(const char* p, double xValue, double* pv, std::string* perr)
+		{
+			Compiled c;
+			if(!c.Compile(p, perr)) return false;
+			return c.Evaluate(xValue, pv);
+		}
+
 		bool Evaluate(const char* p, float xValue, float* pv, std::string* perr)
 		{
-			double vo = 0; if(!Evaluate(p, xValue, &vo, perr)) return false;
+			double vo = 0; if(!Evaluate(p, (double)xValue, &vo, perr)) return false;
 			*pv = (float)vo;
 			return true;
 		}
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 namespace FABB
 {
@@ -25,6 +26,28 @@ namespace FABB
 	namespace MathExpression
 	{
 
+		// an expression compiled once into a stack bytecode, to be evaluated repeatedly
+		// Evaluate() neither parses nor allocates, and gives the same results as the string version
+		class Compiled
+		{
+		public:
+			enum { MaxStackDepth = 32 }; // limits the nesting level
+			struct Instruction
+			{
+				int opcode;
+				double value;
+			};
+			std::vector<Instruction> mCode;
+			Compiled();
+			Compiled(const char* p, std::string* perr = nullptr);
+			// returns false when the expression is invalid, and leaves it empty
+			bool Compile(const char* p, std::string* perr = nullptr);
+			void Clear();
+			bool IsValid() const;
+			bool Evaluate(double xValue, double* pv) const;
+			bool Evaluate(float xValue, float* pv) const;
+		};
+
 		bool Evaluate(const char* p, double xValue, double* pv, std::string* perr = nullptr);
 		bool Evaluate(const char* p, float xValue, float* pv, std::string* perr = nullptr);
 
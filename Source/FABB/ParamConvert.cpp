@@ -12,9 +12,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <memory>
-#include <regex>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "CurveMapping.h"
@@ -25,10 +28,10 @@
 #pragma warning(disable:4127)
 #define strcasecmp _stricmp
 #define strncasecmp _strnicmp
+#else
+#include <strings.h>
 #endif
 
-#define countof(a) (sizeof(a)/sizeof(a[0]))
-
 namespace FABB
 {
 
@@ -74,33 +77,60 @@ namespace FABB
 			return std::string(s, i0, i1 - i0 + 1); // std::move is not required beacuse of 'return value optimization (RVO)'
 		}
 
-		static int RankMatch(const std::string& sa, const std::string& sb)
+		static int RankMatch(const std::string& sa, const char* sb)
 		{
-			if(strcmp(sa.c_str(), sb.c_str()) == 0) return 4;
-			if(strcasecmp(sa.c_str(), sb.c_str()) == 0) return 3;
-			size_t l = (sa.size() < sb.size()) ? sa.size() : sb.size();
-			if(strncmp(sa.c_str(), sb.c_str(), l) == 0) return 2;
-			if(strncasecmp(sa.c_str(), sb.c_str(), l) == 0) return 1;
+			if(strcmp(sa.c_str(), sb) == 0) return 4;
+			if(strcasecmp(sa.c_str(), sb) == 0) return 3;
+			size_t lb = strlen(sb);
+			size_t l = (sa.size() < lb) ? sa.size() : lb;
+			if(strncmp(sa.c_str(), sb, l) == 0) return 2;
+			if(strncasecmp(sa.c_str(), sb, l) == 0) return 1;
 			return 0;
 		}
 
-		static size_t FindMostMatch(const std::vector<std::string>& vs, const std::string& s)
+		static size_t FindMostMatch(const std::vector<std::string>& vs, const char* s)
+		{
+			// the first one of the highest rank
+			size_t im = 0; int rm = -1;
+			for(size_t c = vs.size(), i = 0; i < c; i ++) { int r = RankMatch(vs[i], s); if(rm < r) { rm = r; im = i; } }
+			return im;
+		}
+
+		// [*pp, *ppe) without the leading and the trailing blanks
+		static void TrimRange(const char** pp, const char** ppe, const char* del = "\t\r\n ")
 		{
-			std::vector<int> vr(vs.size(), 0);
-			for(size_t c = vs.size(), i = 0; i < c; i ++) vr[i] = RankMatch(vs[i], s);
-			return std::distance(vr.begin(), std::max_element(vr.begin(), vr.end()));
+			while((*pp < *ppe) && strchr(del, **pp)) (*pp) ++;
+			while((*pp < *ppe) && strchr(del, *(*ppe - 1))) (*ppe) --;
 		}
 
-		static bool IsSameWord(const std::string& sref, const std::string& stest)
+		static bool IsSameWord(const std::string& sref, const char* stest)
 		{
-			std::string sr = Trim(sref);
-			std::string st = Trim(stest);
-			if(sr.size() < st.size()) return false;
-			return strncasecmp(sr.c_str(), st.c_str(), st.size()) == 0;
+			const char* pr = sref.c_str(); const char* pre = pr + sref.size(); TrimRange(&pr, &pre);
+			const char* pt = stest; const char* pte = pt + strlen(pt); TrimRange(&pt, &pte);
+			if((pre - pr) < (pte - pt)) return false;
+			return strncasecmp(pr, pt, pte - pt) == 0;
+		}
+
+		// copies s into ps of cs bytes, truncates when short
+		static void CopyString(const std::string& s, char* ps, size_t cs)
+		{
+			if(!cs) return;
+			size_t l = std::min(s.size(), cs - 1);
+			memcpy(ps, s.data(), l);
+			ps[l] = 0;
 		}
 
 		template<typename T> static bool ParseValue(const std::string& s, T* pv)
 		{
+			// a plain number is taken as is, which gives the same value as the expression
+			const char* p = s.c_str(); while(isspace((unsigned char)*p)) p ++;
+			const char* pn = (*p == '-') ? (p + 1) : p;
+			if(isdigit((unsigned char)*pn) || ((*pn == '.') && isdigit((unsigned char)pn[1])))
+			{
+				char* pe = nullptr; double v = std::strtod(p, &pe);
+				while(isspace((unsigned char)*pe)) pe ++;
+				if(!*pe) { *pv = (T)v; return true; }
+			}
 			return MathExpression::Evaluate(s.c_str(), 0, pv);
 		}
 
@@ -134,61 +164,69 @@ namespace FABB
 		struct Part
 		{
 			std::string fmt, arg;
+			MathExpression::Compiled expr; // arg, compiled at Setup
 			char precision; // used in the case pfxunit ('%k') as the number of effective digits
 			bool pfxunit;
-			Part(const std::string& f, const std::string& a, char pr, bool pu) : fmt(f), arg(a), precision(pr), pfxunit(pu) {}
+			Part(const std::string& f, const std::string& a, char pr, bool pu) : fmt(f), arg(a), precision(pr), pfxunit(pu) { if(!arg.empty()) expr.Compile(arg.c_str()); }
 		};
 		std::vector<Part> mParts;
+		// the conversions are found by a single pass scan, which matches the regular expression "%([ #+\-0-9]*)\.?([0-9]*)([AEFGKaefgk])"
 		void Setup(const std::string& f, const std::vector<std::string>& a)
 		{
-			static const std::regex rx("%([ #+\\-0-9]*)\\.?([0-9]*)([AEFGKaefgk])");
 			mParts.clear();
-			std::string infmt(f);
-			std::smatch m;
+			const char* p = f.c_str();
+			const char* pl = p; // the beginning of the literal
 			size_t iarg = 0;
-			while(std::regex_search(infmt, m, rx))
+			while((p = strchr(p, '%')) != nullptr)
 			{
-				mParts.push_back(Part(m.prefix().str(), "", 0, false));
-				assert(m.size() == 4);
-				std::string part("%");
-				std::string opt1 = m[1].str();
-				std::string opt2 = m[2].str();
-				std::string ts = m[3].str();
-				bool pfx = strcasecmp(ts.c_str(), "k") == 0;
-				char prec = (char)std::stoi(opt2);
+				const char* po = p + 1; // options
+				const char* pd = po; while(*pd && strchr(" #+-0123456789", *pd)) pd ++;
+				const char* pp = (*pd == '.') ? (pd + 1) : pd; // precision
+				const char* pt = pp; while(isdigit((unsigned char)*pt)) pt ++;
+				if(!*pt || !strchr("AEFGKaefgk", *pt)) { p ++; continue; }
+				mParts.push_back(Part(std::string(pl, p), "", 0, false));
+				bool pfx = (*pt == 'K') || (*pt == 'k');
+				int prec = 0; for(const char* pi = pp; pi < pt; pi ++) prec = std::min(prec * 10 + (*pi - '0'), 127);
 				if(pfx && (prec <= 0)) prec = 4; // 4 digits by default
+				std::string part("%");
 				// options
-				part += opt1;
-				if(pfx) opt2 = "X"; // '%.Xf', precision placeholder
-				part += "." + opt2;
+				part.append(po, pd);
+				part += '.';
+				if(pfx) part += '*'; // '%.*f', the precision is given as an argument
+				else part.append(pp, pt);
 				// type specifier
-				if(pfx) ts = "f";
-				part += ts;
+				part += pfx ? 'f' : *pt;
 				if(pfx) part += "%s";
-				mParts.push_back(Part(part, a[iarg ++], prec, pfx));
+				assert(iarg < a.size());
+				mParts.push_back(Part(part, (iarg < a.size()) ? a[iarg] : std::string(), (char)prec, pfx));
+				iarg ++;
 				// next
-				infmt = m.suffix().str();
+				p = pl = pt + 1;
 			}
 			// last suffix
-			mParts.push_back(Part(infmt, "", 0, false));
+			mParts.push_back(Part(pl, "", 0, false));
 		}
-		std::string Print(float v) const
+		// writes into ps of cs bytes without allocating, truncates when short
+		void Print(float v, char* ps, size_t cs) const
 		{
-			std::string sr;
-			for(auto part : mParts)
+			if(!cs) return;
+			size_t l = 0;
+			ps[0] = 0;
+			for(const auto& part : mParts)
 			{
+				if((cs - 1) <= l) break;
+				int n = 0;
 				if(part.arg.empty()) // literal
 				{
-					sr += part.fmt;
+					n = std::snprintf(ps + l, cs - l, "%s", part.fmt.c_str());
 				}
 				else
 				{
-					double vp = 0; MathExpression::Evaluate(part.arg.c_str(), (double)v, &vp);
-					std::string fmt = part.fmt;
-					const char* pfx = "";
+					double vp = 0; part.expr.Evaluate((double)v, &vp);
 					if(part.pfxunit)
 					{
 						// unit prefix
+						const char* pfx = "";
 						double avp = std::abs(vp);
 						if     (1e15  <= avp) { vp *= 1e-15; pfx = "P"; }
 						else if(1e12  <= avp) { vp *= 1e-12; pfx = "T"; }
@@ -216,18 +254,16 @@ namespace FABB
 							dig = std::max(0, std::min(9, (int)part.precision));
 							break;
 						} while(true);
-						std::replace(fmt.begin(), fmt.end(), 'X', (char)('0' + dig));
+						n = std::snprintf(ps + l, cs - l, part.fmt.c_str(), dig, vp, pfx);
+					}
+					else
+					{
+						n = std::snprintf(ps + l, cs - l, part.fmt.c_str(), vp);
 					}
-					char s[128];
-#if defined _MSC_VER
-					_snprintf_s(s, countof(s), fmt.c_str(), vp, pfx);
-#else
-					std::snprintf(s, countof(s), fmt.c_str(), vp, pfx);
-#endif
-					sr += s;
 				}
+				if(n < 0) { ps[l] = 0; break; }
+				l = std::min(l + (size_t)n, cs - 1);
 			}
-			return sr;
 		}
 	};
 
@@ -235,43 +271,51 @@ namespace FABB
 	{
 	public:
 		std::string mFmt, mArg;
+		MathExpression::Compiled mExpr; // mArg, compiled at Setup
 		bool mPfxUnit;
+		// the conversion is found by a single pass scan, which matches the regular expression "%([*0-9]*)([AEFGKaefgk])"
 		void Setup(const std::string& f, const std::string& a)
 		{
-			static const std::regex rx("%([*0-9]*)([AEFGKaefgk])");
-			std::smatch m;
-			if(!std::regex_search(f, m, rx))
+			const char* p = f.c_str();
+			const char* pt = nullptr; // type specifier
+			while((p = strchr(p, '%')) != nullptr)
+			{
+				pt = p + 1; while(*pt && strchr("*0123456789", *pt)) pt ++;
+				if(*pt && strchr("AEFGKaefgk", *pt)) break;
+				p ++;
+			}
+			if(!p)
 			{
 				assert(false);
 				mFmt = f;
 				mArg = "";
+				mExpr.Clear();
 				mPfxUnit = false;
 			}
 			else
 			{
-				assert(m.size() == 3);
-				mFmt = m.prefix();
+				mFmt.assign(f.c_str(), p);
 				mFmt += "%";
 				// options
-				mFmt += m[1].str();
+				mFmt.append(p + 1, pt);
 				// type specifier
-				std::string ts = m[2].str();
-				bool pfx = strcasecmp(ts.c_str(), "k") == 0;
-				if(pfx) ts = "f";
-				mFmt += "l" + ts; // double expected
+				bool pfx = (*pt == 'K') || (*pt == 'k');
+				mFmt += 'l'; // double expected
+				mFmt += pfx ? 'f' : *pt;
 				if(pfx) mFmt += "%c";
-				mFmt += m.suffix().str();
+				mFmt += pt + 1;
 				mArg = a;
+				mExpr.Compile(mArg.c_str());
 				mPfxUnit = pfx;
 			}
 		}
-		bool Scan(const std::string& s, float* pv) const
+		bool Scan(const char* s, float* pv) const
 		{
 			double v = 0; char pfx = 0;
 #if defined _MSC_VER
-			int n = sscanf_s(s.c_str(), mFmt.c_str(), &v, &pfx, sizeof(pfx));
+			int n = sscanf_s(s, mFmt.c_str(), &v, &pfx, sizeof(pfx));
 #else
-			int n = std::sscanf(s.c_str(), mFmt.c_str(), &v, &pfx);
+			int n = std::sscanf(s, mFmt.c_str(), &v, &pfx);
 #endif
 			if(n <= 0) return false;
 			if(mPfxUnit && (n == 2))
@@ -287,7 +331,7 @@ namespace FABB
 				else if(pfx          == 'p') v *= 1e-12;
 				else if(tolower(pfx) == 'f') v *= 1e-15;
 			}
-			return MathExpression::Evaluate(mArg.c_str(), (float)v, pv);
+			return mExpr.Evaluate((float)v, pv);
 		}
 	};
 
@@ -300,6 +344,26 @@ namespace FABB
 		virtual ~IValueConverter() {}
 		virtual bool ControlToNative(float vc, float* pvn) const = 0;
 		virtual bool NativeToControl(float vn, float* pvc) const = 0;
+		// the run versions, Scan*() counts the leading values which the region accepts (or rejects when accept is false)
+		// and *Run() converts the values which the region has accepted, the curves override them with the loops without the checks
+		virtual size_t ScanControl(const float* pvc, size_t l, bool accept) const
+		{
+			size_t i = 0; float v; while((i < l) && (ControlToNative(pvc[i], &v) == accept)) i ++;
+			return i;
+		}
+		virtual size_t ScanNative(const float* pvn, size_t l, bool accept) const
+		{
+			size_t i = 0; float v; while((i < l) && (NativeToControl(pvn[i], &v) == accept)) i ++;
+			return i;
+		}
+		virtual void ControlToNativeRun(const float* pvc, float* pvn, size_t l) const
+		{
+			for(size_t i = 0; i < l; i ++) ControlToNative(pvc[i], &pvn[i]);
+		}
+		virtual void NativeToControlRun(const float* pvn, float* pvc, size_t l) const
+		{
+			for(size_t i = 0; i < l; i ++) NativeToControl(pvn[i], &pvc[i]);
+		}
 	};
 
 	class IStringConverter
@@ -311,8 +375,9 @@ namespace FABB
 		virtual std::vector<std::string> GetEnumStrings() const = 0;
 		virtual bool ControlToEnumIndex(float vc, int* pi) const = 0;
 		virtual bool EnumIndexToControl(int i, float* pvc) const = 0;
-		virtual bool Format(float vc, std::string* ps) const = 0;
-		virtual bool Parse(const std::string& s, float* pvc) const = 0;
+		// writes into ps of cs bytes, truncates when short
+		virtual bool Format(float vc, char* ps, size_t cs) const = 0;
+		virtual bool Parse(const char* s, float* pvc) const = 0;
 	};
 
 	//==============================================================================
@@ -344,6 +409,26 @@ namespace FABB
 			if(vn == mVn) { *pvc = mVc; return true; }
 			return false;
 		}
+		virtual size_t ScanControl(const float* pvc, size_t l, bool accept) const
+		{
+			if(mPermissive) return accept ? l : 0;
+			size_t i = 0; while((i < l) && ((pvc[i] == mVc) == accept)) i ++;
+			return i;
+		}
+		virtual size_t ScanNative(const float* pvn, size_t l, bool accept) const
+		{
+			if(mPermissive) return accept ? l : 0;
+			size_t i = 0; while((i < l) && ((pvn[i] == mVn) == accept)) i ++;
+			return i;
+		}
+		virtual void ControlToNativeRun(const float*, float* pvn, size_t l) const
+		{
+			std::fill(pvn, pvn + l, mVn);
+		}
+		virtual void NativeToControlRun(const float*, float* pvc, size_t l) const
+		{
+			std::fill(pvc, pvc + l, mVc);
+		}
 	};
 
 	class EnumValueConverter : public IValueConverter
@@ -408,6 +493,27 @@ namespace FABB
 			if(mPermissive || ((mVnl <= vn) && (vn <= mVnh))) { *pvc = mMap.Unmap(vn); return true; }
 			return false;
 		}
+		virtual size_t ScanControl(const float* pvc, size_t l, bool accept) const
+		{
+			if(mPermissive) return accept ? l : 0;
+			size_t i = 0; while((i < l) && (((mVcl <= pvc[i]) && (pvc[i] <= mVch)) == accept)) i ++;
+			return i;
+		}
+		virtual size_t ScanNative(const float* pvn, size_t l, bool accept) const
+		{
+			if(mPermissive) return accept ? l : 0;
+			size_t i = 0; while((i < l) && (((mVnl <= pvn[i]) && (pvn[i] <= mVnh)) == accept)) i ++;
+			return i;
+		}
+		// no branches in the loops, so that the compiler can vectorize them
+		virtual void ControlToNativeRun(const float* pvc, float* pvn, size_t l) const
+		{
+			for(size_t i = 0; i < l; i ++) pvn[i] = mMap.Map(pvc[i]);
+		}
+		virtual void NativeToControlRun(const float* pvn, float* pvc, size_t l) const
+		{
+			for(size_t i = 0; i < l; i ++) pvc[i] = mMap.Unmap(pvn[i]);
+		}
 	};
 
 	class ExpValueConverter : public IValueConverter
@@ -436,6 +542,27 @@ namespace FABB
 			if(mPermissive || ((mVnl <= vn) && (vn <= mVnh))) { *pvc = mMap.Unmap(vn); return true; }
 			return false;
 		}
+		virtual size_t ScanControl(const float* pvc, size_t l, bool accept) const
+		{
+			if(mPermissive) return accept ? l : 0;
+			size_t i = 0; while((i < l) && (((mVcl <= pvc[i]) && (pvc[i] <= mVch)) == accept)) i ++;
+			return i;
+		}
+		virtual size_t ScanNative(const float* pvn, size_t l, bool accept) const
+		{
+			if(mPermissive) return accept ? l : 0;
+			size_t i = 0; while((i < l) && (((mVnl <= pvn[i]) && (pvn[i] <= mVnh)) == accept)) i ++;
+			return i;
+		}
+		// no branches in the loops, so that the compiler can vectorize them
+		virtual void ControlToNativeRun(const float* pvc, float* pvn, size_t l) const
+		{
+			for(size_t i = 0; i < l; i ++) pvn[i] = mMap.Map(pvc[i]);
+		}
+		virtual void NativeToControlRun(const float* pvn, float* pvc, size_t l) const
+		{
+			for(size_t i = 0; i < l; i ++) pvc[i] = mMap.Unmap(pvn[i]);
+		}
 	};
 
 	//==============================================================================
@@ -470,13 +597,13 @@ namespace FABB
 			if(mPermissive || (i == 0)) { *pvc = mVc; return true; }
 			return false;
 		}
-		virtual bool Format(float vc, std::string* ps) const
+		virtual bool Format(float vc, char* ps, size_t cs) const
 		{
 			if(mPermissive) vc = mVc;
-			if(vc == mVc) { *ps = mF; return true; }
+			if(vc == mVc) { ParamUtil::CopyString(mF, ps, cs); return true; }
 			return false;
 		}
-		virtual bool Parse(const std::string& s, float* pvc) const
+		virtual bool Parse(const char* s, float* pvc) const
 		{
 			if(mPermissive || ParamUtil::IsSameWord(mF, s)) { *pvc = mVc; return true; }
 			return false;
@@ -519,14 +646,14 @@ namespace FABB
 			if(ii < mFormats.size()) { *pvc = mMap.Unmap((float)ii); return true; }
 			return false;
 		}
-		virtual bool Format(float vc, std::string* ps) const
+		virtual bool Format(float vc, char* ps, size_t cs) const
 		{
 			if(mPermissive) vc = ParamUtil::Limit(mVcl, mVch, vc);
 			size_t i = (size_t)(mMap.Map(vc) + 0.5f);
-			if(i < mFormats.size()) { *ps = mFormats[i]; return true; }
+			if(i < mFormats.size()) { ParamUtil::CopyString(mFormats[i], ps, cs); return true; }
 			return false;
 		}
-		virtual bool Parse(const std::string& s, float* pvc) const
+		virtual bool Parse(const char* s, float* pvc) const
 		{
 			size_t i = ParamUtil::FindMostMatch(mFormats, s);
 			if(mPermissive) i = ParamUtil::Limit((size_t)0, mFormats.size() - 1, i);
@@ -564,17 +691,17 @@ namespace FABB
 		virtual std::vector<std::string> GetEnumStrings() const { return std::vector<std::string>(); }
 		virtual bool ControlToEnumIndex(float, int*) const { return false; }
 		virtual bool EnumIndexToControl(int, float*) const { return false; }
-		virtual bool Format(float vc, std::string* ps) const
+		virtual bool Format(float vc, char* ps, size_t cs) const
 		{
 			if(mPermissive || ((mVcl <= vc) && (vc <= mVch)))
 			{
 				float v = mMap.Map(vc);
-				*ps = mPrintFormat.Print(v);
+				mPrintFormat.Print(v, ps, cs);
 				return true;
 			}
 			return false;
 		}
-		virtual bool Parse(const std::string& s, float* pvc) const
+		virtual bool Parse(const char* s, float* pvc) const
 		{
 			float vx = 0; if(mScanFormat.Scan(s, &vx))
 			{
@@ -617,17 +744,17 @@ namespace FABB
 		virtual std::vector<std::string> GetEnumStrings() const { return std::vector<std::string>(); }
 		virtual bool ControlToEnumIndex(float, int*) const { return false; }
 		virtual bool EnumIndexToControl(int, float*) const { return false; }
-		virtual bool Format(float vc, std::string* ps) const
+		virtual bool Format(float vc, char* ps, size_t cs) const
 		{
 			if(mPermissive || ((mVcl <= vc) && (vc <= mVch)))
 			{
 				float v = mMap.Map(vc);
-				*ps = mPrintFormat.Print(v);
+				mPrintFormat.Print(v, ps, cs);
 				return true;
 			}
 			return false;
 		}
-		virtual bool Parse(const std::string& s, float* pvc) const
+		virtual bool Parse(const char* s, float* pvc) const
 		{
 			float vx = 0; if(mScanFormat.Scan(s, &vx) == 1)
 			{
@@ -746,6 +873,54 @@ namespace FABB
 		return mVcDef;
 	}
 
+	namespace ParamUtil
+	{
+		// the length of the leading run which the k-th region converts, i.e. which it accepts and none of the preceding regions does,
+		// scan(i, o, l, accept) is Scan*() of the i-th region from the offset o
+		// the run is extended by a window which doubles while the run fills it, and each value is scanned once per region,
+		// so that a pass stays linear in the length, also when the values alternate between the regions, or fall out of all of them
+		template<typename TScan> static size_t ScanRun(size_t k, size_t l, TScan scan)
+		{
+			size_t n = 0;
+			for(size_t w = std::min<size_t>(l, 8); ; w = std::min(l, 2 * w))
+			{
+				size_t m = scan(k, n, w - n, true);
+				for(size_t i = 0; i < k; i ++) m = scan(i, n, m, false);
+				n += m;
+				if((n < w) || (w == l)) return n;
+			}
+		}
+	}
+
+	void ParamConverter::ControlToNative(const float* pvc, float* pvn, size_t l) const
+	{
+		size_t c = mValConv.size();
+		while(0 < l)
+		{
+			// the region of the first value, the same one as ControlToNative(float) finds
+			size_t k = 0;
+			while((k < c) && (mValConv[k]->ScanControl(pvc, 1, true) == 0)) k ++;
+			if(k == c) { *pvn ++ = 0; pvc ++; l --; continue; }
+			size_t n = ParamUtil::ScanRun(k, l, [&](size_t i, size_t o, size_t m, bool accept) { return mValConv[i]->ScanControl(pvc + o, m, accept); });
+			mValConv[k]->ControlToNativeRun(pvc, pvn, n);
+			pvc += n; pvn += n; l -= n;
+		}
+	}
+
+	void ParamConverter::NativeToControl(const float* pvn, float* pvc, size_t l) const
+	{
+		size_t c = mValConv.size();
+		while(0 < l)
+		{
+			size_t k = 0;
+			while((k < c) && (mValConv[k]->ScanNative(pvn, 1, true) == 0)) k ++;
+			if(k == c) { *pvc ++ = mVcDef; pvn ++; l --; continue; }
+			size_t n = ParamUtil::ScanRun(k, l, [&](size_t i, size_t o, size_t m, bool accept) { return mValConv[i]->ScanNative(pvn + o, m, accept); });
+			mValConv[k]->NativeToControlRun(pvn, pvc, n);
+			pvn += n; pvc += n; l -= n;
+		}
+	}
+
 	bool ParamConverter::IsInteger() const
 	{
 		return mIsInteger;
@@ -806,18 +981,31 @@ namespace FABB
 		return mVcDef;
 	}
 
+	bool ParamConverter::Format(float vc, char* ps, size_t cs) const
+	{
+		for(size_t c = mStrConv.size(), i = 0; i < c; i ++) { if(mStrConv[i]->Format(vc, ps, cs)) return true; }
+		if(cs) ps[0] = 0;
+		return false;
+	}
+
 	std::string ParamConverter::Format(float vc) const
 	{
-		for(size_t c = mStrConv.size(), i = 0; i < c; i ++) { std::string s; if(mStrConv[i]->Format(vc, &s)) return s; }
-		return std::string();
+		char s[MaxTextLength];
+		Format(vc, s, sizeof(s));
+		return s;
 	}
 
-	float ParamConverter::Parse(const std::string& s) const
+	float ParamConverter::Parse(const char* s) const
 	{
 		for(size_t c = mStrConv.size(), i = 0; i < c; i ++) { float p; if(mStrConv[i]->Parse(s, &p)) return ParamUtil::Limit(mVcMin, mVcMax, p); }
 		return mVcDef;
 	}
 
+	float ParamConverter::Parse(const std::string& s) const
+	{
+		return Parse(s.c_str());
+	}
+
 	//==============================================================================
 	// ParamConverterTable
 
@@ -916,4 +1104,19 @@ namespace FABB
 	ParamConverter* ParamConverterTable::At(const char* k) { auto it = mMap.find(k ? k : ""); return (it != mMap.end()) ? it->second : nullptr; }
 	ParamConverter* ParamConverterTable::operator[](const char* k) { auto it = mMap.find(k ? k : ""); return (it != mMap.end()) ? it->second : nullptr; }
 
+	std::shared_ptr<const ParamConverterTable> ParamConverterTable::Share(const char* const* ps, size_t cs)
+	{
+		static std::mutex mutex;
+		static std::map<std::pair<const char* const*, size_t>, std::weak_ptr<const ParamConverterTable> > registry;
+		std::lock_guard<std::mutex> lock(mutex);
+		std::weak_ptr<const ParamConverterTable>& entry = registry[std::make_pair(ps, cs)];
+		std::shared_ptr<const ParamConverterTable> table = entry.lock();
+		if(!table)
+		{
+			table = std::make_shared<const ParamConverterTable>(ps, cs);
+			entry = table;
+		}
+		return table;
+	}
+
 } // namespace FABB
@@ -139,6 +139,9 @@ namespace FABB
 		float LimitNativeValue(float vn) const;
 		float ControlToNative(float vc) const;
 		float NativeToControl(float vn) const;
+		// the array versions, the region is resolved once per run of the values which stay in the same region
+		void ControlToNative(const float* pvc, float* pvn, size_t l) const;
+		void NativeToControl(const float* pvn, float* pvc, size_t l) const;
 		// IsInteger: include both 'continuous integers' and 'enum values'
 		bool IsInteger() const;
 		int ControlToNativeInt(float vc) const;
@@ -148,7 +151,11 @@ namespace FABB
 		std::vector<std::string> GetEnumStrings() const;
 		int ControlToEnumIndex(float vc) const;
 		float EnumIndexToControl(int ii) const;
+		// the display text, Format(vc, ps, cs) writes into ps of cs bytes without allocating, and truncates when short
+		enum { MaxTextLength = 128 };
+		bool Format(float vc, char* ps, size_t cs) const;
 		std::string Format(float vc) const;
+		float Parse(const char* s) const;
 		float Parse(const std::string& s) const;
 	};
 
@@ -184,6 +191,10 @@ namespace FABB
 		ParamConverter* operator[](size_t i);
 		ParamConverter* At(const char* k);
 		ParamConverter* operator[](const char* k);
+		// returns the table loaded from the static initializers, shared by all the callers in the process
+		// the profile is parsed at the first call, and released when the last reference is gone
+		// ps must be a static array, which is also used as the identity of the profile
+		static std::shared_ptr<const ParamConverterTable> Share(const char* const* ps, size_t cs);
 	};
 
 } // namespace FABB
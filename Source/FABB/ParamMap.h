@@ -0,0 +1,140 @@
+//
+//  ParamMap.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "FastMath.h"
+#include "ParamConvert.h"
+
+namespace FABB
+{
+
+	/*
+	the typed, compile-time form of the ParamConverter value converters (cf. <valueconverter> in ParamConvert.h)
+	each map is a literal type, so that a profile can be a constexpr object,
+	and ControlToNative() is inlined without the virtual calls and the region search
+	the regions are composed with Either<> in the same order as in the profile string, the last one clamps as the last region does
+	the string profile is still used for the names and the display texts, Matches() checks that both forms agree
+
+	"lin!0~1!0~12"						: Lin(0, 1, 0, 12)
+	"exp!0~1!0.001~1"					: Exp(0, 1, 0.001f, 1)
+	"enum!0~1!1,2,3"					: Enum<3>(0, 1, { 1, 2, 3 })
+	"pt!0!0; exp!0~1!0.1~10"			: Either<Pt, Exp>(Pt(0, 0), Exp(0, 1, 0.1f, 10))
+	*/
+	namespace ParamMap
+	{
+
+		// "pt!vc!vn"
+		struct Pt
+		{
+			float mVc, mVn;
+			constexpr Pt(float vc, float vn) : mVc(vc), mVn(vn) {}
+			constexpr bool TryControlToNative(float vc, float* pvn) const { if(vc == mVc) { *pvn = mVn; return true; } return false; }
+			constexpr bool TryNativeToControl(float vn, float* pvc) const { if(vn == mVn) { *pvc = mVc; return true; } return false; }
+			constexpr float ControlToNative(float) const { return mVn; }
+			constexpr float NativeToControl(float) const { return mVc; }
+		};
+
+		// "lin!vcl~vch!vnl~vnh", the same arithmetic as CurveMapLinear
+		struct Lin
+		{
+			float mVcl, mVch, mVnl, mVnh;
+			float mAr, mBr, mRcpAr, mRcpBr;
+			constexpr Lin(float vcl, float vch, float vnl, float vnh)
+				: mVcl(vcl), mVch(vch), mVnl(vnl), mVnh(vnh)
+				, mAr(vch - vcl), mBr(vnh - vnl), mRcpAr(1 / (vch - vcl)), mRcpBr(1 / (vnh - vnl))
+			{}
+			constexpr bool TryControlToNative(float vc, float* pvn) const { if((mVcl <= vc) && (vc <= mVch)) { *pvn = ControlToNative(vc); return true; } return false; }
+			constexpr bool TryNativeToControl(float vn, float* pvc) const { if((mVnl <= vn) && (vn <= mVnh)) { *pvc = NativeToControl(vn); return true; } return false; }
+			constexpr float ControlToNative(float vc) const { return mVnl + (vc - mVcl) * mBr * mRcpAr; }
+			constexpr float NativeToControl(float vn) const { return mVcl + (vn - mVnl) * mAr * mRcpBr; }
+		};
+
+		// "exp!vcl~vch!vnl~vnh", the same arithmetic as CurveMapExponential
+		// the logarithms are not constexpr, they are folded by the compiler when the map is a constant
+		struct Exp
+		{
+			float mVcl, mVch, mVnl, mVnh;
+			float mAr, mRcpAr, mRcpSc;
+			constexpr Exp(float vcl, float vch, float vnl, float vnh)
+				: mVcl(vcl), mVch(vch), mVnl(vnl), mVnh(vnh)
+				, mAr(vch - vcl), mRcpAr(1 / (vch - vcl)), mRcpSc(1 / vnl)
+			{}
+			float Pw() const { return std::log(mVnh) - std::log(mVnl); }
+			bool TryControlToNative(float vc, float* pvn) const { if((mVcl <= vc) && (vc <= mVch)) { *pvn = ControlToNative(vc); return true; } return false; }
+			bool TryNativeToControl(float vn, float* pvc) const { if((mVnl <= vn) && (vn <= mVnh)) { *pvc = NativeToControl(vn); return true; } return false; }
+			float ControlToNative(float vc) const { return MathPolicyDefault::Exp((vc - mVcl) * mRcpAr * Pw()) * mVnl; }
+			float NativeToControl(float vn) const { return mVcl + mAr * MathPolicyDefault::Log(vn * mRcpSc) * (1 / Pw()); }
+		};
+
+		// "enum!vcl~vch!n0,n1,..."
+		template<size_t N> struct Enum
+		{
+			static_assert(2 <= N, "Enum needs two values at least");
+			float mVcl, mVch;
+			std::array<int, N> mValues;
+			Lin mIndexMap;
+			constexpr Enum(float vcl, float vch, const std::array<int, N>& values) : mVcl(vcl), mVch(vch), mValues(values), mIndexMap(vcl, vch, 0, (float)(N - 1)) {}
+			constexpr float LimitControl(float vc) const { return (vc <= mVch) ? ((mVcl <= vc) ? vc : mVcl) : mVch; }
+			constexpr int ControlToIndex(float vc) const { return (int)(mIndexMap.ControlToNative(LimitControl(vc)) + 0.5f); }
+			constexpr bool TryControlToNative(float vc, float* pvn) const
+			{
+				size_t i = (size_t)(mIndexMap.ControlToNative(vc) + 0.5f);
+				if(i < N) { *pvn = (float)mValues[i]; return true; }
+				return false;
+			}
+			constexpr bool TryNativeToControl(float vn, float* pvc) const
+			{
+				for(size_t i = 0; i < N; i ++) { if(mValues[i] == (int)vn) { *pvc = mIndexMap.NativeToControl((float)i); return true; } }
+				return false;
+			}
+			constexpr float ControlToNative(float vc) const { return (float)mValues[(size_t)ControlToIndex(vc)]; }
+			constexpr float NativeToControl(float vn) const { float vc = 0; return TryNativeToControl(vn, &vc) ? vc : mIndexMap.NativeToControl((float)(N - 1)); }
+		};
+
+		// the regions in order, the first one that accepts the value is used
+		template<class TA, class TB> struct Either
+		{
+			TA mA;
+			TB mB;
+			constexpr Either(const TA& a, const TB& b) : mA(a), mB(b) {}
+			bool TryControlToNative(float vc, float* pvn) const { return mA.TryControlToNative(vc, pvn) || mB.TryControlToNative(vc, pvn); }
+			bool TryNativeToControl(float vn, float* pvc) const { return mA.TryNativeToControl(vn, pvc) || mB.TryNativeToControl(vn, pvc); }
+			float ControlToNative(float vc) const { float vn = 0; return mA.TryControlToNative(vc, &vn) ? vn : mB.ControlToNative(vc); }
+			float NativeToControl(float vn) const { float vc = 0; return mA.TryNativeToControl(vn, &vc) ? vc : mB.NativeToControl(vn); }
+		};
+
+		// cf. ParamConverter::ControlToNativeInt
+		template<class TMap> int ControlToNativeInt(const TMap& m, float vc)
+		{
+			float vn = m.ControlToNative(vc);
+			return (int)((0 <= vn) ? (vn + 0.5f) : (vn - 0.5f));
+		}
+
+		// compares with the converter built from the profile string, at the points evenly spaced over the control range
+		// allows a few ulps, for the compilers which contract the multiply-adds differently in the inlined code
+		template<class TMap> bool Matches(const TMap& m, const ParamConverter& pc, int points = 101)
+		{
+			auto same = [](float a, float b) { return (a == b) || (std::abs(a - b) <= 1e-6f * std::max(std::abs(a), std::abs(b))); };
+			for(int i = 0; i < points; i ++)
+			{
+				float vc = pc.ControlMin() + (pc.ControlMax() - pc.ControlMin()) * (float)i / (float)(points - 1);
+				float vn = pc.ControlToNative(vc);
+				if(!same(m.ControlToNative(vc), vn)) return false;
+				if(!same(m.NativeToControl(vn), pc.NativeToControl(vn))) return false;
+			}
+			return true;
+		}
+
+	} // namespace ParamMap
+
+} // namespace FABB
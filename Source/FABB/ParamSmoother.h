@@ -0,0 +1,273 @@
+//
+//  ParamSmoother.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace FABB
+{
+
+	// linear ramp from the current value to the target in the specified number of samples
+	template<typename T> class LinearRampT
+	{
+	public:
+		T mValue, mTarget, mDelta;
+		int mCount;
+		LinearRampT(T v = 0)
+		{
+			Reset(v);
+		}
+		// jumps to the value immediately
+		void Reset(T v)
+		{
+			mValue = mTarget = v;
+			mDelta = 0;
+			mCount = 0;
+		}
+		// reaches the target at the l-th sample
+		void SetTarget(T v, int l)
+		{
+			if(l <= 0) { Reset(v); return; }
+			mTarget = v;
+			mDelta = (mTarget - mValue) / (T)l;
+			mCount = l;
+		}
+		T GetValue() const
+		{
+			return mValue;
+		}
+		T GetTarget() const
+		{
+			return mTarget;
+		}
+		bool IsRamping() const
+		{
+			return 0 < mCount;
+		}
+		T Process()
+		{
+			if(0 < mCount)
+			{
+				mValue += mDelta;
+				if(-- mCount == 0) mValue = mTarget;
+			}
+			return mValue;
+		}
+		void Process(T* p, size_t l)
+		{
+			while(l --) *p ++ = Process();
+		}
+	};
+
+	using LinearRampF = LinearRampT<float>;
+	using LinearRampD = LinearRampT<double>;
+
+	// parameter smoother evaluated once per block
+	// the value follows the target along a straight line within each block, so that the gain stages can apply it as g0+dg*i
+	//   Linear     : moves at a constant rate to reach the target in mTime samples
+	//   Exponential: approaches the target with the time-constant of mTime samples, evaluated at the block ends in closed form,
+	//                and snaps to the target when it comes closer than Epsilon()
+	// mTime=0 makes the changes immediate
+	template<typename T> class BlockSmootherT
+	{
+	public:
+		enum Mode { Linear, Exponential };
+		static constexpr T Epsilon() { return (T)1e-5; }
+		Mode mMode;
+		T mTime; // in samples
+		T mValue, mTarget;
+		T mRate; // per sample, for Linear
+		BlockSmootherT(T v = 0)
+		{
+			mMode = Exponential;
+			mTime = 0;
+			Reset(v);
+		}
+		void SetMode(Mode v)
+		{
+			mMode = v;
+			SetTarget(mTarget);
+		}
+		void SetTime(T v)
+		{
+			mTime = (0 < v) ? v : 0;
+			SetTarget(mTarget);
+		}
+		// jumps to the value immediately
+		void Reset(T v)
+		{
+			mValue = mTarget = v;
+			mRate = 0;
+		}
+		// jumps to the current target immediately
+		void Snap()
+		{
+			Reset(mTarget);
+		}
+		void SetTarget(T v)
+		{
+			mTarget = v;
+			if(mTime <= 0) { mValue = v; mRate = 0; }
+			else mRate = std::abs(mTarget - mValue) / mTime;
+		}
+		T GetValue() const
+		{
+			return mValue;
+		}
+		T GetTarget() const
+		{
+			return mTarget;
+		}
+		bool IsSmoothing() const
+		{
+			return mValue != mTarget;
+		}
+		// advances l samples, and returns the ramp of this block as v0 (at the first sample) and the increment per sample
+		T NextBlock(int l, T* pv0)
+		{
+			T v0 = mValue;
+			*pv0 = v0;
+			if((v0 == mTarget) || (l <= 0)) return 0;
+			T v1;
+			if(mMode == Linear)
+			{
+				T d = mTarget - v0, s = mRate * (T)l;
+				v1 = (std::abs(d) <= s) ? mTarget : ((d < 0) ? (v0 - s) : (v0 + s));
+			}
+			else
+			{
+				v1 = mTarget + (v0 - mTarget) * std::exp(-(T)l / mTime);
+				if(std::abs(v1 - mTarget) < Epsilon()) v1 = mTarget;
+			}
+			mValue = v1;
+			return (v1 - v0) / (T)l;
+		}
+	};
+
+	using BlockSmootherF = BlockSmootherT<float>;
+	using BlockSmootherD = BlockSmootherT<double>;
+
+	// BlockSmootherT evaluated at the ends of the cells of mGrid samples on the time line, instead of at the block ends,
+	// so that the ramp does not depend on how the time line is splitted into the blocks (up to the rounding of g0+dg*i)
+	// the time line starts at Align(), a target change in the middle of a cell ramps to the cell end from the current value
+	template<typename T> class GridSmootherT
+	{
+	public:
+		enum { DefaultGrid = 32 };
+		using Mode = typename BlockSmootherT<T>::Mode;
+		BlockSmootherT<T> mSmoother; // at the current position when mPhase=0, or at the end of the current cell
+		int mGrid, mPhase; // the cell length, and the position in the cell
+		T mV0, mDelta; // the ramp of the current cell, the value at mPhase is mV0+mDelta*mPhase
+		GridSmootherT(T v = 0, int grid = DefaultGrid) : mSmoother(v)
+		{
+			mGrid = std::max(1, grid);
+			mPhase = 0;
+			mV0 = v;
+			mDelta = 0;
+		}
+		// restarts the time line at the current sample
+		void Align()
+		{
+			T v = GetValue(), t = GetTarget();
+			mPhase = 0;
+			mSmoother.Reset(v);
+			mSmoother.SetTarget(t);
+			mV0 = v;
+			mDelta = 0;
+		}
+		void SetGrid(int v)
+		{
+			mGrid = std::max(1, v);
+			Align();
+		}
+		void SetMode(Mode v)
+		{
+			mSmoother.SetMode(v);
+			internalRetarget(GetTarget());
+		}
+		void SetTime(T v)
+		{
+			mSmoother.SetTime(v);
+			internalRetarget(GetTarget());
+		}
+		// jumps to the value immediately
+		void Reset(T v)
+		{
+			mSmoother.Reset(v);
+			mV0 = v;
+			mDelta = 0;
+		}
+		// jumps to the current target immediately
+		void Snap()
+		{
+			Reset(GetTarget());
+		}
+		void SetTarget(T v)
+		{
+			internalRetarget(v);
+		}
+		T GetValue() const
+		{
+			return (0 < mPhase) ? (mV0 + mDelta * (T)mPhase) : mSmoother.GetValue();
+		}
+		T GetTarget() const
+		{
+			return mSmoother.GetTarget();
+		}
+		bool IsSmoothing() const
+		{
+			return (GetValue() != GetTarget()) || (mDelta != 0);
+		}
+		// advances l samples, fn(i, n, v0, dv) is called for each piece of the cells, the value at the (i+k)-th sample is v0+dv*k
+		template<typename TFn> void Ramp(int l, TFn fn)
+		{
+			for(int i = 0; i < l; )
+			{
+				if(mPhase == 0)
+				{
+					// constant in the whole cells, when not moving
+					if(!mSmoother.IsSmoothing())
+					{
+						T v = mSmoother.GetValue();
+						fn(i, l - i, v, (T)0);
+						mPhase = (l - i) % mGrid;
+						mV0 = v;
+						mDelta = 0;
+						return;
+					}
+					internalStartCell();
+				}
+				int n = std::min(l - i, mGrid - mPhase);
+				fn(i, n, mV0 + mDelta * (T)mPhase, mDelta);
+				i += n;
+				mPhase = (mPhase + n) % mGrid;
+			}
+		}
+		// for the internal use
+		// restarts the smoothing from the current value, and the rest of the current cell
+		void internalRetarget(T v)
+		{
+			mSmoother.Reset(GetValue());
+			mSmoother.SetTarget(v);
+			if(0 < mPhase) internalStartCell();
+		}
+		void internalStartCell()
+		{
+			T v0;
+			mDelta = mSmoother.NextBlock(mGrid - mPhase, &v0);
+			mV0 = v0 - mDelta * (T)mPhase;
+		}
+	};
+
+	using GridSmootherF = GridSmootherT<float>;
+	using GridSmootherD = GridSmootherT<double>;
+
+} // namespace FABB
@@ -0,0 +1,75 @@
+//
+//  SPSCQueue.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace FABB
+{
+
+	// bounded queue from one producer thread to one consumer thread, wait-free and allocation free for both sides
+	// N must be a power of two, the indices run freely and wrap around by the modulo
+	template<typename T, size_t N> class SPSCQueueT
+	{
+	public:
+		static_assert((N != 0) && ((N & (N - 1)) == 0), "N must be a power of two");
+		std::array<T, N> mItems;
+		alignas(64) std::atomic<uint32_t> mHead; // written by the producer
+		alignas(64) std::atomic<uint32_t> mTail; // written by the consumer
+		SPSCQueueT()
+		{
+			mHead.store(0, std::memory_order_relaxed);
+			mTail.store(0, std::memory_order_relaxed);
+		}
+		// for the producer, returns false when the queue is full
+		bool Push(const T& v)
+		{
+			uint32_t h = mHead.load(std::memory_order_relaxed);
+			uint32_t t = mTail.load(std::memory_order_acquire);
+			if(N <= (size_t)(h - t)) return false;
+			mItems[h % N] = v;
+			mHead.store(h + 1, std::memory_order_release);
+			return true;
+		}
+		// for the consumer, the oldest item, or nullptr when the queue is empty
+		const T* Peek() const
+		{
+			uint32_t t = mTail.load(std::memory_order_relaxed);
+			uint32_t h = mHead.load(std::memory_order_acquire);
+			return (t != h) ? &mItems[t % N] : nullptr;
+		}
+		// for the consumer, removes the item returned by Peek()
+		void Pop()
+		{
+			uint32_t t = mTail.load(std::memory_order_relaxed);
+			mTail.store(t + 1, std::memory_order_release);
+		}
+		bool Pop(T* pv)
+		{
+			const T* p = Peek();
+			if(!p) return false;
+			*pv = *p;
+			Pop();
+			return true;
+		}
+		// for the consumer, discards all the items pushed so far
+		void Clear()
+		{
+			mTail.store(mHead.load(std::memory_order_acquire), std::memory_order_release);
+		}
+		bool IsEmpty() const
+		{
+			return Peek() == nullptr;
+		}
+	};
+
+} // namespace FABB
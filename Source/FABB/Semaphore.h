@@ -0,0 +1,121 @@
+//
+//  Semaphore.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <dispatch/dispatch.h>
+#else
+#include <semaphore.h>
+#endif
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+namespace FABB
+{
+
+	// counting semaphore for a handoff between two threads
+	// Post() is lock-free, and enters the kernel only to wake a thread blocked in Wait()
+	// Wait() spins for the given count before it blocks, for a handoff expected to complete soon
+	class Semaphore
+	{
+	public:
+		std::atomic<int> mCount; // the negative count is the number of the threads blocked, or about to block
+#if defined(_WIN32)
+		HANDLE mSem;
+#elif defined(__APPLE__)
+		dispatch_semaphore_t mSem;
+#else
+		sem_t mSem;
+#endif
+		Semaphore()
+		{
+			mCount.store(0, std::memory_order_relaxed);
+#if defined(_WIN32)
+			mSem = CreateSemaphoreW(nullptr, 0, 0x7fffffff, nullptr);
+#elif defined(__APPLE__)
+			mSem = dispatch_semaphore_create(0);
+#else
+			sem_init(&mSem, 0, 0);
+#endif
+		}
+		~Semaphore()
+		{
+#if defined(_WIN32)
+			CloseHandle(mSem);
+#elif defined(__APPLE__)
+			dispatch_release(mSem);
+#else
+			sem_destroy(&mSem);
+#endif
+		}
+		Semaphore(const Semaphore&) = delete;
+		Semaphore& operator=(const Semaphore&) = delete;
+		void Post()
+		{
+			if(mCount.fetch_add(1, std::memory_order_release) < 0) internalPost();
+		}
+		bool TryWait()
+		{
+			int c = mCount.load(std::memory_order_relaxed);
+			while(0 < c)
+			{
+				if(mCount.compare_exchange_weak(c, c - 1, std::memory_order_acquire, std::memory_order_relaxed)) return true;
+			}
+			return false;
+		}
+		void Wait(int spin = 0)
+		{
+			for(int i = 0; i < spin; i ++)
+			{
+				if(TryWait()) return;
+				Pause();
+			}
+			if(mCount.fetch_sub(1, std::memory_order_acquire) <= 0) internalWait();
+		}
+		// a hint to the processor in the spin loops
+		static void Pause()
+		{
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+			_mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+			__asm__ __volatile__("yield");
+#endif
+		}
+		// for the internal use
+		void internalPost()
+		{
+#if defined(_WIN32)
+			ReleaseSemaphore(mSem, 1, nullptr);
+#elif defined(__APPLE__)
+			dispatch_semaphore_signal(mSem);
+#else
+			sem_post(&mSem);
+#endif
+		}
+		void internalWait()
+		{
+#if defined(_WIN32)
+			WaitForSingleObject(mSem, INFINITE);
+#elif defined(__APPLE__)
+			dispatch_semaphore_wait(mSem, DISPATCH_TIME_FOREVER);
+#else
+			while((sem_wait(&mSem) != 0) && (errno == EINTR)) {}
+#endif
+		}
+	};
+
+} // namespace FABB
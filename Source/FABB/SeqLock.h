@@ -0,0 +1,66 @@
+//
+//  SeqLock.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace FABB
+{
+
+	// sequence lock to publish a snapshot from one writer to any number of readers
+	// the writer never waits, the readers retry while the writer is in progress
+	// the data is kept in atomic words, so that the torn reads are well-defined and just discarded
+	template<typename T> class SeqLockT
+	{
+	public:
+		static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+		enum { NumWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t) };
+		std::atomic<uint32_t> mSeq;
+		std::array<std::atomic<uint32_t>, NumWords> mWords;
+		SeqLockT()
+		{
+			mSeq.store(0, std::memory_order_relaxed);
+			for(auto&& w : mWords) w.store(0, std::memory_order_relaxed);
+		}
+		// for the single writer, wait-free
+		void Store(const T& v)
+		{
+			uint32_t words[NumWords] = {};
+			std::memcpy(words, &v, sizeof(T));
+			uint32_t seq = mSeq.load(std::memory_order_relaxed);
+			mSeq.store(seq + 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			for(int i = 0; i < NumWords; i ++) mWords[i].store(words[i], std::memory_order_relaxed);
+			mSeq.store(seq + 2, std::memory_order_release);
+		}
+		// returns false when the writer was in progress
+		bool TryLoad(T* pv) const
+		{
+			uint32_t words[NumWords];
+			uint32_t seq0 = mSeq.load(std::memory_order_acquire);
+			if(seq0 & 1) return false;
+			for(int i = 0; i < NumWords; i ++) words[i] = mWords[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			uint32_t seq1 = mSeq.load(std::memory_order_relaxed);
+			if(seq0 != seq1) return false;
+			std::memcpy(pv, words, sizeof(T));
+			return true;
+		}
+		void Load(T* pv) const
+		{
+			while(!TryLoad(pv)) std::this_thread::yield();
+		}
+	};
+
+} // namespace FABB
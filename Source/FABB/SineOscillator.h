@@ -9,11 +9,12 @@
 #pragma once
 
 #include <cmath>
+#include "FastMath.h"
 
 namespace FABB
 {
 
-	template<typename T> class SineOscillatorT
+	template<typename T, class TMath = MathPolicyDefault> class SineOscillatorT
 	{
 	public:
 		static constexpr T TWOPI() { return (T)6.283185307179586476925286766559; }
@@ -34,7 +35,7 @@ namespace FABB
 		}
 		T Process()
 		{
-			T v = std::sin(mPhase * TWOPI());
+			T v = TMath::Sin(mPhase * TWOPI());
 			mPhase += mFreq; while(1 <= mPhase) mPhase -= 1;
 			return v;
 		}
@@ -0,0 +1,110 @@
+//
+//  TimeHistogram.h
+//  Fundamental Audio Building Blocks
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace FABB
+{
+
+	// lock-free histogram of the durations in nanoseconds, for one writer and any number of readers
+	// the bins are log-linear, SubCount bins per octave, so that a percentile is accurate within 1/SubCount (12.5%)
+	// the values below 2*SubCount are exact, and the values beyond 2^MaxBits fall into the last bin
+	// the readers may see the statistics of the different moments, which is harmless for the monitoring
+	class TimeHistogram
+	{
+	public:
+		enum { SubBits = 3, SubCount = 1 << SubBits, MaxBits = 40, BinCount = (MaxBits - SubBits + 1) * SubCount };
+		struct Stats { uint64_t count, min, max, p99; double mean; };
+		std::array<std::atomic<uint32_t>, BinCount> mBins;
+		std::atomic<uint64_t> mCount, mSum, mMin, mMax;
+		TimeHistogram()
+		{
+			Reset();
+		}
+		// for the writer
+		void Reset()
+		{
+			for(auto&& b : mBins) b.store(0, std::memory_order_relaxed);
+			mCount.store(0, std::memory_order_relaxed);
+			mSum.store(0, std::memory_order_relaxed);
+			mMin.store(UINT64_MAX, std::memory_order_relaxed);
+			mMax.store(0, std::memory_order_relaxed);
+		}
+		// for the writer, wait-free, the single writer needs no read-modify-write
+		void Add(uint64_t v)
+		{
+			std::atomic<uint32_t>& b = mBins[BinIndex(v)];
+			b.store(b.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			mSum.store(mSum.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+			if(v < mMin.load(std::memory_order_relaxed)) mMin.store(v, std::memory_order_relaxed);
+			if(mMax.load(std::memory_order_relaxed) < v) mMax.store(v, std::memory_order_relaxed);
+			mCount.store(mCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+		// for the readers
+		uint64_t Percentile(double q) const
+		{
+			uint64_t total = 0;
+			for(auto&& b : mBins) total += b.load(std::memory_order_relaxed);
+			if(total == 0) return 0;
+			uint64_t target = (uint64_t)(q * (double)total + 0.5);
+			if(target < 1) target = 1;
+			uint64_t acc = 0;
+			for(int i = 0; i < BinCount; i ++)
+			{
+				acc += mBins[i].load(std::memory_order_relaxed);
+				if(target <= acc)
+				{
+					uint64_t vmax = mMax.load(std::memory_order_relaxed);
+					uint64_t v = BinUpper(i);
+					return (vmax < v) ? vmax : v;
+				}
+			}
+			return mMax.load(std::memory_order_relaxed);
+		}
+		void GetStats(Stats* ps) const
+		{
+			ps->count = mCount.load(std::memory_order_acquire);
+			uint64_t sum = mSum.load(std::memory_order_relaxed);
+			ps->min = (0 < ps->count) ? mMin.load(std::memory_order_relaxed) : 0;
+			ps->max = mMax.load(std::memory_order_relaxed);
+			ps->mean = (0 < ps->count) ? ((double)sum / (double)ps->count) : 0.0;
+			ps->p99 = Percentile(0.99);
+		}
+		// the bin mapping
+		static int internalMSB(uint64_t v)
+		{
+			int n = 0;
+			if(v >> 32) { v >>= 32; n += 32; }
+			if(v >> 16) { v >>= 16; n += 16; }
+			if(v >> 8) { v >>= 8; n += 8; }
+			if(v >> 4) { v >>= 4; n += 4; }
+			if(v >> 2) { v >>= 2; n += 2; }
+			if(v >> 1) { n += 1; }
+			return n;
+		}
+		static int BinIndex(uint64_t v)
+		{
+			if(v < (uint64_t)SubCount) return (int)v;
+			int e = internalMSB(v);
+			int i = (e - SubBits + 1) * SubCount + (int)((v >> (e - SubBits)) & (SubCount - 1));
+			return (i < BinCount) ? i : (BinCount - 1);
+		}
+		static uint64_t BinUpper(int i)
+		{
+			if(i < 2 * SubCount) return (uint64_t)i;
+			int e = i / SubCount + SubBits - 1;
+			uint64_t lower = (uint64_t)(SubCount + i % SubCount) << (e - SubBits);
+			return lower + ((uint64_t)1 << (e - SubBits)) - 1;
+		}
+	};
+
+} // namespace FABB
@@ -0,0 +1,152 @@
+//
+//  InstrumentScheduler.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "PulseInstrument.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// schedules the MIDI events of a block into the PulseInstrument rendering
+// - the events are sorted by the sample position
+// - the controllers (modulation wheel, pitch bend) are coalesced per sub-block of ControlBlockSize samples,
+//   the last value in a sub-block becomes the target of a linear ramp that ends at the end of the sub-block
+// - the note events split the rendering at their exact positions,
+//   but the events closer than MinRenderLength to the previous split are applied together at the previous split
+// - the queue keeps NoteReserve slots for the note events, a note-off in the full queue evicts a controller or a note-on,
+//   so that a burst of controllers never drops a note event, and no note is left hanging
+// the timing shifts against the exact positions:
+// - a controller change is quantized to its sub-block, the ramp starts at the sub-block start (or the last note split in it)
+//   and reaches the value at the sub-block end, i.e. up to ControlBlockSize-1 samples early to start, and as much late to settle
+// - a note event is pulled up to MinRenderLength-1 samples early, onto the previous split
+// - the sub-blocks are counted from the start of each ProcessAdd() call, so the shifts depend on how the host splits the blocks
+class InstrumentScheduler
+{
+public:
+	enum { MaxEvents = 1024, NoteReserve = 256, ControlBlockSize = 32, MinRenderLength = 8 };
+	struct Event
+	{
+		int pos;
+		uint8_t status, data1, data2;
+		bool IsController() const
+		{
+			uint8_t st = status & 0xf0U;
+			return ((st == 0xb0U) && (data1 == 1)) || (st == 0xe0U);
+		}
+		bool IsNote() const
+		{
+			uint8_t st = status & 0xf0U;
+			return (st == 0x80U) || (st == 0x90U);
+		}
+		bool IsNoteOn() const
+		{
+			return ((status & 0xf0U) == 0x90U) && (0 < data2);
+		}
+	};
+	std::array<Event, MaxEvents> mEvents;
+	int mCount;
+	InstrumentScheduler()
+	{
+		mCount = 0;
+	}
+	void Clear()
+	{
+		mCount = 0;
+	}
+	// returns false when the event is not used by the instrument, or the queue is full
+	bool Add(int pos, const uint8_t* p, int l)
+	{
+		if(l < 1) return false;
+		Event ev = { pos, p[0], (1 < l) ? p[1] : (uint8_t)0, (2 < l) ? p[2] : (uint8_t)0 };
+		if(!ev.IsController() && !ev.IsNote()) return false;
+		// coalesce the controller stream already here, only the last value in a sub-block is used anyway
+		if(ev.IsController())
+		{
+			for(int i = mCount - 1; (0 <= i) && ((mEvents[i].pos / ControlBlockSize) == (pos / ControlBlockSize)); i --)
+			{
+				Event& evp = mEvents[i];
+				if(evp.IsController() && ((evp.status & 0xf0U) == (ev.status & 0xf0U)) && (evp.pos <= pos)) { evp = ev; return true; }
+			}
+			if((MaxEvents - NoteReserve) <= mCount) return false;
+		}
+		else if(MaxEvents <= mCount)
+		{
+			// a dropped note-on is harmless, its note-off finds no voice, but a dropped note-off leaves the note hanging
+			if(ev.IsNoteOn() || !internalEvict()) return false;
+		}
+		mEvents[mCount ++] = ev;
+		return true;
+	}
+	// renders the block, and clears the events
+	void ProcessAdd(PulseInstrument& inst, float* p, int l)
+	{
+		internalSort();
+		int ie = 0;
+		int ismp = 0;
+		for(int iblk = 0; iblk < l; iblk += ControlBlockSize)
+		{
+			int iblke = std::min(l, iblk + ControlBlockSize);
+			if((mCount <= ie) || (iblke <= mEvents[ie].pos)) continue;
+			// coalesce the controllers in this sub-block
+			bool hasmod = false, hasbend = false;
+			float vmod = 0, vbend = 0;
+			for(int i = ie; (i < mCount) && (mEvents[i].pos < iblke); i ++)
+			{
+				const Event& ev = mEvents[i];
+				if((ev.status & 0xf0U) == 0xb0U) { hasmod = true; vmod = (float)ev.data2 / 127.0f; }
+				else if((ev.status & 0xf0U) == 0xe0U)
+				{
+					int wh = (int)(((uint16_t)ev.data2 << 7) | (uint16_t)ev.data1) - 8192;
+					hasbend = true; vbend = (float)wh / 8192.0f;
+				}
+			}
+			if(hasmod || hasbend)
+			{
+				int iramp = std::max(ismp, iblk);
+				if(ismp < iramp) { inst.ProcessAdd(p + ismp, iramp - ismp); ismp = iramp; }
+				if(hasmod) inst.RampLFOModCtrl(vmod, iblke - ismp);
+				if(hasbend) inst.RampPitchBendCtrl(vbend, iblke - ismp);
+			}
+			// notes at the exact positions
+			for(; (ie < mCount) && (mEvents[ie].pos < iblke); ie ++)
+			{
+				const Event& ev = mEvents[ie];
+				if(!ev.IsNote()) continue;
+				if((ismp + MinRenderLength) <= ev.pos) { inst.ProcessAdd(p + ismp, ev.pos - ismp); ismp = ev.pos; }
+				if(((ev.status & 0xf0U) == 0x90U) && (0 < ev.data2)) inst.NoteOn(ev.data1);
+				else inst.NoteOff(ev.data1);
+			}
+		}
+		if(ismp < l) inst.ProcessAdd(p + ismp, l - ismp);
+		Clear();
+	}
+	// for the internal use
+	// removes the latest controller, or the latest note-on when there is none, returns false when neither is found
+	bool internalEvict()
+	{
+		int ie = -1;
+		for(int i = mCount - 1; (0 <= i) && (ie < 0); i --) if(mEvents[i].IsController()) ie = i;
+		for(int i = mCount - 1; (0 <= i) && (ie < 0); i --) if(mEvents[i].IsNoteOn()) ie = i;
+		if(ie < 0) return false;
+		std::copy(mEvents.begin() + ie + 1, mEvents.begin() + mCount, mEvents.begin() + ie);
+		mCount --;
+		return true;
+	}
+	// insertion sort, stable and allocation free, and linear for the already sorted events
+	void internalSort()
+	{
+		for(int i = 1; i < mCount; i ++)
+		{
+			Event ev = mEvents[i];
+			int j = i;
+			while((0 < j) && (ev.pos < mEvents[j - 1].pos)) { mEvents[j] = mEvents[j - 1]; j --; }
+			mEvents[j] = ev;
+		}
+	}
+};
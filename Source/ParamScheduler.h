@@ -0,0 +1,93 @@
+//
+//  ParamScheduler.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "FABB/SPSCQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+// schedules the timestamped parameter changes into the VocoderCore block processing
+// - the changes are queued by one producer thread in the time order, with the sample time counted from Reset()
+// - a change is applied at its exact sample, but not sooner than MinSegmentLength samples after the previous change point,
+//   the changes closer than that are deferred to that point and applied together, so that the processing is never splitted
+//   into the segments shorter than MinSegmentLength by the changes (the block boundaries of the host still split it)
+// - the distance is measured on the time line, so that a change lands at the same sample however the host splits the blocks
+// - the changes due before the current block are applied at the block start
+// the host automation through AudioProcessorParameter::setValue() has no sample time, and does not come through here,
+// it is still applied at the start of the next block, see VocoderCore::ApplyParamChanges()
+class ParamScheduler
+{
+public:
+	enum { QueueSize = 1024, MinSegmentLength = 32 };
+	struct Event
+	{
+		int64_t time;
+		int id;
+		float value;
+	};
+	FABB::SPSCQueueT<Event, QueueSize> mQueue;
+	std::atomic<int64_t> mTime; // at the current block start, written by the audio thread
+	int64_t mLastChange; // the time of the previous change point, for the audio thread
+	ParamScheduler()
+	{
+		mTime.store(0, std::memory_order_relaxed);
+		mLastChange = INT64_MIN / 2;
+	}
+	// for the producer thread, returns false when the queue is full
+	bool Add(int64_t time, int id, float value)
+	{
+		return mQueue.Push({ time, id, value });
+	}
+	// can be called from any thread
+	int64_t GetTime() const
+	{
+		return mTime.load(std::memory_order_relaxed);
+	}
+	// the following are for the audio thread
+	// restarts the time line, and discards the queued changes
+	void Reset()
+	{
+		mQueue.Clear();
+		mTime.store(0, std::memory_order_relaxed);
+		mLastChange = INT64_MIN / 2;
+	}
+	// the position of the next change after pos in the current block of l samples, or l when there is no more
+	// a change pushed late while the block is being processed is taken at the next position
+	int NextChange(int pos, int l) const
+	{
+		const Event* pe = mQueue.Peek();
+		return pe ? (int)std::min<int64_t>(l, std::max<int64_t>(pos + 1, internalPosition(pe->time))) : l;
+	}
+	// takes the changes due at pos or before, and calls fn(id, value) for each
+	template<typename TFn> void TakeChanges(int pos, TFn fn)
+	{
+		const Event* pe = mQueue.Peek();
+		if(!pe || (pos < internalPosition(pe->time))) return;
+		// all the changes up to the current sample are applied together, and it becomes the previous change point
+		int64_t due = mTime.load(std::memory_order_relaxed) + pos;
+		for(; pe && (pe->time <= due); pe = mQueue.Peek())
+		{
+			fn(pe->id, pe->value);
+			mQueue.Pop();
+		}
+		mLastChange = due;
+	}
+	// moves the time line to the next block
+	void Advance(int l)
+	{
+		mTime.store(mTime.load(std::memory_order_relaxed) + l, std::memory_order_relaxed);
+	}
+	// for the internal use
+	// the position in the current block where a change at time is applied, negative when late
+	int64_t internalPosition(int64_t time) const
+	{
+		return std::max(time, mLastChange + MinSegmentLength) - mTime.load(std::memory_order_relaxed);
+	}
+};
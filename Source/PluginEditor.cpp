@@ -18,10 +18,12 @@ class LevelBar : public Component
 public:
 	Range<float> mRange;
 	float mValue;
+	float mPeak; // drawn as a line, hidden when out of the range
 	bool mVertical;
 	LevelBar()
 		: mRange(0, 1)
 		, mValue(0)
+		, mPeak(0)
 		, mVertical(true)
 	{
 	}
@@ -33,15 +35,19 @@ public:
 		rc.reduce(1, 1);
 		g.setColour(Colours::lime);
 		float ratio = (mValue - mRange.getStart()) / mRange.getLength();
+		float ratiopk = (mPeak - mRange.getStart()) / mRange.getLength();
+		bool haspk = (0 < ratiopk) && (ratiopk <= 1);
 		if(mVertical)
 		{
 			float cy = rc.getHeight(), cyb = cy * ratio;
 			g.fillRect(Rectangle<float>(rc.getX(), rc.getY() + cy - cyb, rc.getWidth(), cyb));
+			if(haspk) { g.setColour(Colours::yellow); g.fillRect(Rectangle<float>(rc.getX(), rc.getY() + cy - cy * ratiopk, rc.getWidth(), 1)); }
 		}
 		else
 		{
 			float cx = rc.getWidth(), cxb = cx * ratio;
 			g.fillRect(Rectangle<float>(rc.getX(), rc.getY(), cxb, rc.getHeight()));
+			if(haspk) { g.setColour(Colours::yellow); g.fillRect(Rectangle<float>(rc.getX() + cx * ratiopk - 1, rc.getY(), 1, rc.getHeight())); }
 		}
 	}
 	void setRange(const Range<float>& v)
@@ -54,6 +60,11 @@ public:
 		mValue = v;
 		repaint();
 	}
+	void setPeak(float v)
+	{
+		mPeak = v;
+		repaint();
+	}
 	void setVertical(bool v)
 	{
 		mVertical = v;
@@ -208,14 +219,82 @@ public:
 	{
 		VocoderAudioProcessor::Levels lv; mProcessor->getLevels(&lv);
 		for(size_t c = mSigBars.size(), i = 0; i < c; ++i) mSigBars[i].levelbar.setValue(20 * std::log10(FLT_EPSILON + lv.ios[i]));
-		for(size_t c = mChBars.size(), i = 0; i < c; ++i) mChBars[i].levelbar.setValue(20 * std::log10(FLT_EPSILON + lv.modbands[i]));
+		for(size_t c = mChBars.size(), i = 0; i < c; ++i)
+		{
+			mChBars[i].levelbar.setValue(20 * std::log10(FLT_EPSILON + lv.modbands[i]));
+			mChBars[i].levelbar.setPeak(20 * std::log10(FLT_EPSILON + lv.modbandpeaks[i]));
+		}
+	}
+};
+
+#if VOCODER_PROFILING
+// ===============================================================================
+// ProfilePane
+
+// CPU breakdown per stage, the mean is drawn as a bar relative to the mean of the whole block
+// click to reset the statistics
+class ProfilePane : public Component, public Timer
+{
+public:
+	VocoderAudioProcessor* mProcessor;
+	ProfileStats mStats;
+	enum { Margin = 8, RowHeight = 15, NameWidth = 80, BarWidth = 120, Spacing = 8 };
+	ProfilePane(VocoderAudioProcessor* p)
+		: mProcessor(p)
+		, mStats()
+	{
+		jassert(mProcessor != nullptr);
+		startTimer(500);
+	}
+	static int getNaturalHeight()
+	{
+		return Margin * 2 + RowHeight * (ProfileStage::Count + 1);
+	}
+	virtual void paint(Graphics& g) override
+	{
+		g.fillAll(Colour(0xff202020));
+		g.setFont(Font(12.0f, Font::FontStyleFlags::plain));
+		Rectangle<int> rc = getLocalBounds().reduced(Margin);
+		Rectangle<int> rch = rc.removeFromTop(RowHeight);
+		g.setColour(Colours::grey);
+		g.drawText("stage", rch.removeFromLeft(NameWidth), Justification::centredLeft);
+		rch.removeFromLeft(BarWidth + Spacing);
+		g.drawText(String::formatted("mean / p99 / max [us], %d blocks", (int)mStats.stages[ProfileStage::Total].count), rch, Justification::centredLeft);
+		double total = mStats.stages[ProfileStage::Total].mean;
+		for(int i = 0; i < ProfileStage::Count; i ++)
+		{
+			const FABB::TimeHistogram::Stats& st = mStats.stages[i];
+			Rectangle<int> rcr = rc.removeFromTop(RowHeight);
+			g.setColour(Colours::lightgrey);
+			g.drawText(ProfileStage::Name(i), rcr.removeFromLeft(NameWidth), Justification::centredLeft);
+			Rectangle<int> rcb = rcr.removeFromLeft(BarWidth).reduced(0, 3);
+			rcr.removeFromLeft(Spacing);
+			g.setColour(Colours::black);
+			g.fillRect(rcb);
+			float ratio = (0 < total) ? (float)jlimit(0.0, 1.0, st.mean / total) : 0.0f;
+			g.setColour(Colours::orange);
+			g.fillRect(rcb.withWidth(roundToInt((float)rcb.getWidth() * ratio)));
+			g.setColour(Colours::lightgrey);
+			g.drawText(String::formatted("%.1f / %.1f / %.1f", st.mean * 1e-3, (double)st.p99 * 1e-3, (double)st.max * 1e-3), rcr, Justification::centredLeft);
+		}
+	}
+	virtual void mouseDown(const MouseEvent&) override
+	{
+		mProcessor->resetProfileStats();
+	}
+	// Timer
+	virtual void timerCallback() override
+	{
+		mProcessor->getProfileStats(&mStats);
+		repaint();
 	}
 };
 
+#endif
 // ===============================================================================
 // ParamSectionPane
 
-class ParamBoundSlider : public Component, protected Slider::Listener
+class ParamBoundSlider : public Component, protected Slider::Listener, protected AudioProcessorParameter::Listener
 {
 public:
 	AudioProcessorParameter* mParam;
@@ -234,8 +313,13 @@ public:
 		mSlider.textFromValueFunction = [this](double v)->String { return mParam ? mParam->getText((float)v, 256) : String("---"); };
 		addAndMakeVisible(mSlider);
 	}
+	virtual ~ParamBoundSlider()
+	{
+		if(mParam) mParam->removeListener(this);
+	}
 	void bindToObject(AudioProcessorParameter* p)
 	{
+		if(mParam) mParam->removeListener(this);
 		mParam = p;
 		if(mParam)
 		{
@@ -244,6 +328,7 @@ public:
 			mSlider.setRange(0, 1, dv);
 			mSlider.setDoubleClickReturnValue(true, mParam->getDefaultValue());
 			mSlider.setValue(mParam->getValue(), NotificationType::dontSendNotification);
+			mParam->addListener(this);
 		}
 	}
 	virtual void resized() override
@@ -258,6 +343,15 @@ public:
 	{
 		if(mParam) mParam->setValueNotifyingHost((float)slider->getValue());
 	}
+	// AudioProcessorParameter::Listener
+	// the program changes are notified on the message thread, see VocoderAudioProcessorImpl::timerCallback()
+	virtual void parameterValueChanged(int, float v) override
+	{
+		if(MessageManager::existsAndIsCurrentThread()) mSlider.setValue(v, NotificationType::dontSendNotification);
+	}
+	virtual void parameterGestureChanged(int, bool) override
+	{
+	}
 };
 
 class ParamSectionPane : public GroupComponent
@@ -316,6 +410,9 @@ protected:
 	std::unique_ptr<ParamSectionPane> mVocSection;
 	std::unique_ptr<ParamSectionPane> mInstSection;
 	std::unique_ptr<LevelMeterPane> mLevelMeter;
+#if VOCODER_PROFILING
+	std::unique_ptr<ProfilePane> mProfilePane;
+#endif
 	enum { Margin = 10, BarsHeight = 200 };
 public:
 	VocoderAudioProcessorEditorImpl(VocoderAudioProcessor& v) : VocoderAudioProcessorEditor(v), processor(v)
@@ -326,7 +423,7 @@ public:
 		static const std::vector<int> VOCPIDs = { ParamID::VocNoiseGain, ParamID::VocBandShift };
 		mVocSection = std::make_unique<ParamSectionPane>(&processor, VOCPIDs, "Vocoder");
 		addAndMakeVisible(mVocSection.get());
-		static const std::vector<int> InstPIDs = { ParamID::InstPortamentoTime, ParamID::InstAttackTime, ParamID::InstReleaseTime, ParamID::InstLFORate, ParamID::InstModRange, ParamID::InstBendRange, ParamID::InstMonoMode };
+		static const std::vector<int> InstPIDs = { ParamID::InstPortamentoTime, ParamID::InstAttackTime, ParamID::InstReleaseTime, ParamID::InstLFORate, ParamID::InstModRange, ParamID::InstBendRange, ParamID::InstMonoMode, ParamID::InstUnisonCount, ParamID::InstUnisonDetune };
 		mInstSection = std::make_unique<ParamSectionPane>(&processor, InstPIDs, "Instrument");
 		addAndMakeVisible(mInstSection.get());
 		mLevelMeter = std::make_unique<LevelMeterPane>(&processor);
@@ -336,8 +433,16 @@ public:
 		int cxvoc = mVocSection->getNaturalWidth();
 		int cxio = mSigSection->getNaturalWidth();
 		Rectangle<int> rc = { Margin * 2 + cxio + cxvoc + cxinst, Margin * 2 + BarsHeight + cyparams };
+#if VOCODER_PROFILING
+		mProfilePane = std::make_unique<ProfilePane>(&processor);
+		addAndMakeVisible(mProfilePane.get());
+		rc.setHeight(rc.getHeight() + ProfilePane::getNaturalHeight());
+#endif
 		Rectangle<int> rci = rc.reduced(Margin);
 		mLevelMeter->setBounds(rci.removeFromTop(BarsHeight));
+#if VOCODER_PROFILING
+		mProfilePane->setBounds(rci.removeFromBottom(ProfilePane::getNaturalHeight()));
+#endif
 		mSigSection->setBounds(rci.removeFromLeft(cxio));
 		mVocSection->setBounds(rci.removeFromLeft(cxvoc));
 		mInstSection->setBounds(rci.removeFromLeft(cxinst));
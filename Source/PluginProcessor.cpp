@@ -8,174 +8,8 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
-#include "PulseInstrument.h"
-#include "ChannelVocoder.h"
-#include "FABB/EnvelopeFollower.h"
-#include <array>
-
-// ===============================================================================
-// VocoderCore
-
-static const char* const gParamProfile[] =
-{
-	//			 nameunit					 param			 valueconvert					 stringconvert
-	"IPT"	"\t" "Portamento;sec."	"\t" "0~1;N0.01"	"\t" "exp!0~1!0.001~1"			"\t" "exp!0~1!0.001~1!%.3f,x!%f,x",
-	"IAT"	"\t" "Attack;sec."		"\t" "0~1;N0.01"	"\t" "exp!0~1!0.001~1"			"\t" "exp!0~1!0.001~1!%.3f,x!%f,x",
-	"IRT"	"\t" "Release;sec."		"\t" "0~1;N0.01"	"\t" "exp!0~1!0.001~1"			"\t" "exp!0~1!0.001~1!%.3f,x!%f,x",
-	"ILR"	"\t" "LFORate;Hz"		"\t" "0~1;N5"		"\t" "exp!0~1!0.1~100"			"\t" "exp!0~1!0.1~100!%.2f,x!%f,x",
-	"IMR"	"\t" "ModRange"			"\t" "0~1;N2"		"\t" "lin!0~1!0~12"				"\t" "pt!0!Off; lin!0~1!0~12!%.2f,x!%f,x",
-	"IBR"	"\t" "BendRange"		"\t" "0~1;N2"		"\t" "lin!0~1!0~12"				"\t" "pt!0!Off; lin!0~1!0~12!%.2f,x!%f,x",
-	"IMM"	"\t" "Mode"				"\t" "0~1;N1"		"\t" "enum!0~1!0,1"				"\t" "enum!0~1!mono,poly",
-	"CG"	"\t" "Carrier;dB"		"\t" "0~1;N2"		"\t" "pt!0!0; exp!0~1!0.1~10"	"\t" "pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x",
-	"MG"	"\t" "Modulator;dB"		"\t" "0~1;N2"		"\t" "pt!0!0; exp!0~1!0.1~10"	"\t" "pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x",
-	"OG"	"\t" "Output;dB"		"\t" "0~1;N2"		"\t" "pt!0!0; exp!0~1!0.1~10"	"\t" "pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x",
-	"NG"	"\t" "Noise;dB"			"\t" "0~1;N0.5"		"\t" "pt!0!0; exp!0~1!0.1~10"	"\t" "pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x",
-	"BS"	"\t" "Band Shift"		"\t" "0~1;N0;int"	"\t" "lin!0~1!-4~4"				"\t" "lin!0~1!-4~4!%.0f,x!%f,x",
-};
-
-class LevelMeter : public FABB::EnvelopeFollowerF
-{
-public:
-	void ProcessWrite(const float* p, int l)
-	{
-		while(l --) Process(*p ++);
-	}
-};
-
-class VocoderCore
-{
-public:
-	CriticalSection mLock;
-	FABB::ParamConverterTable mParamConverterTable;
-	PulseInstrument mInstrument;
-	ChannelVocoder mVocoder;
-	std::array<LevelMeter, 3> mIOMeters;
-	std::array<float, ParamID::Count> mChunk;
-	float mCarrierGain, mModulatorGain, mOutputGain;
-	int mNchC, mNchM, mNchO;
-	VocoderCore()
-	{
-		mNchC = mNchM = mNchO = 0;
-		mParamConverterTable.Load(gParamProfile, numElementsInArray(gParamProfile));
-		jassert(mParamConverterTable.Count() == ParamID::Count);
-		for(int ip = 0; ip < ParamID::Count; ip ++)
-		{
-			const FABB::ParamConverter* pc = mParamConverterTable[ip];
-			mChunk[ip] = pc->ControlDef();
-			SetParam(ip, mChunk[ip]);
-		}
-	}
-	const FABB::ParamConverter* GetParamConverter(int ip) const
-	{
-		return mParamConverterTable[ip];
-	}
-	float GetParam(int ip) const
-	{
-		return mChunk[ip];
-	}
-	void SetParam(int ip, float v)
-	{
-		ScopedLock sl(mLock);
-		mChunk[ip] = v;
-		const FABB::ParamConverter* pc = mParamConverterTable[ip];
-		switch(ip)
-		{
-			case ParamID::InstPortamentoTime: mInstrument.SetPortamentoTime(pc->ControlToNative(v)); break;
-			case ParamID::InstAttackTime: mInstrument.SetAttackTime(pc->ControlToNative(v)); break;
-			case ParamID::InstReleaseTime: mInstrument.SetReleaseTime(pc->ControlToNative(v)); break;
-			case ParamID::InstLFORate: mInstrument.SetLFORate(pc->ControlToNative(v)); break;
-			case ParamID::InstModRange: mInstrument.SetModRange(pc->ControlToNative(v)); break;
-			case ParamID::InstBendRange: mInstrument.SetBendRange(pc->ControlToNative(v)); break;
-			case ParamID::InstMonoMode: mInstrument.setMonoMode(pc->ControlToEnumIndex(v) == 0); break;
-			case ParamID::IOCarrierGain: mCarrierGain = pc->ControlToNative(v); break;
-			case ParamID::IOModulatorGain: mModulatorGain = pc->ControlToNative(v); break;
-			case ParamID::IOOutputGain: mOutputGain = pc->ControlToNative(v); break;
-			case ParamID::VocNoiseGain: mVocoder.setNoiseGain(pc->ControlToNative(v)); break;
-			case ParamID::VocBandShift: mVocoder.SetBandShift(pc->ControlToNativeInt(v)); break;
-		}
-	}
-	void Prepare(double fs, int nchc, int nchm, int ncho)
-	{
-		mNchC = nchc;
-		mNchM = nchm;
-		mNchO = ncho;
-		mInstrument.Prepare(fs);
-		mVocoder.Prepare(fs);
-		for(auto&& lv : mIOMeters)
-		{
-			lv.SetAttackTC(0.01f * (float)fs);
-			lv.SetReleaseTC(0.1f * (float)fs);
-		}
-	}
-	void Unprepare()
-	{
-		mInstrument.Unprepare();
-		mVocoder.Unprepare();
-		mNchC = mNchM = mNchO = 0;
-	}
-	virtual void Process(AudioSampleBuffer& asb, MidiBuffer& mb)
-	{
-		ScopedLock sl(mLock);
-		if((mNchC < 1) || (mNchM < 1) || (mNchO < 1) || (asb.getNumChannels() < (mNchC + mNchM)) || (asb.getNumChannels() < mNchO)) { return; }
-		int ichc = 0;
-		int ichm = ichc + mNchC;
-		int icho = 0;
-		int lenbuf = asb.getNumSamples();
-		// mix carrier channels into ch0
-		if(1 < mNchC) asb.addFrom(ichc, 0, asb, ichc + 1, 0, lenbuf);
-		// mix rendered instrument
-		int ismp = 0;
-		for(const MidiMessageMetadata mm : mb)
-		{
-			mInstrument.ProcessAdd(asb.getWritePointer(ichc, ismp), mm.samplePosition - ismp);
-			ismp = mm.samplePosition;
-			// DBG(String::toHexString(mm.data, mm.numBytes));
-			switch(mm.data[0] & 0xf0U)
-			{
-				case 0x80U:
-					mInstrument.NoteOff(mm.data[1]);
-					break;
-				case 0x90U:
-					if(0 < mm.data[2]) mInstrument.NoteOn(mm.data[1]);
-					else mInstrument.NoteOff(mm.data[1]);
-					break;
-				case 0xb0U:
-					if(mm.data[1] == 1)
-					{
-						float vwh = (float)mm.data[2] / 127.0f;
-						mInstrument.SetLFOModCtrl(vwh);
-					}
-					break;
-				case 0xe0U:
-				{
-					int wh = (int)(((uint16)mm.data[2] << 7) | (uint16)mm.data[1]) - 8192;
-					float vwh = (float)wh / 8192.0f;
-					mInstrument.SetPitchBendCtrl(vwh);
-					break;
-				}
-			}
-		}
-		if(ismp < lenbuf) mInstrument.ProcessAdd(asb.getWritePointer(ichc, ismp), lenbuf - ismp);
-		asb.applyGain(ichc, 0, lenbuf, mCarrierGain);
-		mIOMeters[0].ProcessWrite(asb.getReadPointer(ichc), lenbuf);
-		// mix modulator channel into ch2
-		if(1 < mNchM) asb.addFrom(ichm, 0, asb, ichm + 1, 0, lenbuf);
-		asb.applyGain(ichm, 0, lenbuf, mModulatorGain);
-		mIOMeters[1].ProcessWrite(asb.getReadPointer(ichm), lenbuf);
-		// process vocoder
-		mVocoder.Process(asb.getReadPointer(ichc), asb.getReadPointer(ichm), asb.getWritePointer(icho), lenbuf);
-		// output
-		asb.applyGain(icho, 0, lenbuf, mOutputGain);
-		if(1 < mNchO) asb.copyFrom(icho + 1, 0, asb, icho, 0, lenbuf);
-		mIOMeters[2].ProcessWrite(asb.getReadPointer(icho), lenbuf);
-	}
-	void GetLevels(VocoderAudioProcessor::Levels* pv) const
-	{
-		ScopedLock sl(mLock);
-		for(size_t c = mIOMeters.size(), i = 0; i < c; i ++) pv->ios[i] = mIOMeters[i].GetValue();
-		mVocoder.GetModLevels(&pv->modbands);
-	}
-};
+#include "VocoderCore.h"
+#include "RTSafetyChecker.h"
 
 // ===============================================================================
 // VocoderAudioProcessor
@@ -193,6 +27,7 @@ public:
 		, mIndex(ip)
 	{}
 	virtual float getValue() const override { return mCore->GetParam(mIndex); }
+	// the host gives no sample time, the value is applied at the next block start
 	virtual void setValue(float v) override { mCore->SetParam(mIndex, v); }
 	virtual float getDefaultValue() const override { return mParamConverter->ControlDef(); }
 	virtual int getNumSteps() const override
@@ -202,26 +37,39 @@ public:
 		return 0x7fffffff;
 	}
 	virtual bool isDiscrete() const override { return mParamConverter->IsEnum() || mParamConverter->IsInteger(); }
-	virtual String getText(float v, int) const override { return mParamConverter->Format(v); }
-	virtual float getValueForText(const String& s) const override { return mParamConverter->Parse(s.toStdString()); }
+	virtual String getText(float v, int) const override { char s[FABB::ParamConverter::MaxTextLength]; mParamConverter->Format(v, s, sizeof(s)); return String::fromUTF8(s); }
+	virtual float getValueForText(const String& s) const override { return mParamConverter->Parse(s.toRawUTF8()); }
 };
 
-class VocoderAudioProcessorImpl : public VocoderAudioProcessor
+class VocoderAudioProcessorImpl : public VocoderAudioProcessor, private Timer
 {
 private:
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VocoderAudioProcessorImpl)
 public:
-	std::unique_ptr<VocoderCore> mCore;
+	VocoderCore mCore;
 	VocoderAudioProcessorImpl() : VocoderAudioProcessor(BusesProperties()
 		.withInput("InstInput", AudioChannelSet::stereo(), true)
 		.withInput("VoiceInput", AudioChannelSet::stereo(), true)
 		.withOutput("Output", AudioChannelSet::stereo(), true))
 	{
-		mCore = std::make_unique<VocoderCore>();
-		for(int ip = 0; ip < ParamID::Count; ip ++) addParameter(new VocoderParameter(mCore.get(), ip));
+		for(int ip = 0; ip < ParamID::Count; ip ++) addParameter(new VocoderParameter(&mCore, ip));
+		startTimerHz(30);
 	}
 	virtual ~VocoderAudioProcessorImpl()
 	{
+		stopTimer();
+	}
+	// Timer
+	// the program changes are applied on the audio thread, and notified to the host and the editor here on the message thread
+	virtual void timerCallback() override
+	{
+		const auto& params = getParameters();
+		uint32_t changed = mCore.TakeChangedParams();
+		for(int ip = 0; changed != 0; ip ++, changed >>= 1)
+		{
+			if(changed & 1u) params[ip]->sendValueChangedMessageToListeners(mCore.GetParam(ip));
+		}
+		if(mCore.TakeProgramChanged()) updateHostDisplay(AudioProcessorListener::ChangeDetails().withProgramChanged(true));
 	}
 	bool guessChannels(const BusesLayout& layouts, int* pcchcOrz, int* pcchmOrz, int* pcchoOrz) const
 	{
@@ -263,23 +111,24 @@ public:
 	}
 #endif
 	// processing
-	virtual void prepareToPlay(double fs, int) override
+	virtual void prepareToPlay(double fs, int maxblock) override
 	{
 		BusesLayout layouts = getBusesLayout();
 		int cchc = 0, cchm = 0, ccho = 0;
 		guessChannels(layouts, &cchc, &cchm, &ccho);
 		DBG(String::formatted("[VocoderAudioProcessor] prepare carrier=%d modulator=%d output=%d", cchc, cchm, ccho));
-		mCore->Prepare(fs, cchc, cchm, ccho);
+		mCore.Prepare(fs, maxblock, cchc, cchm, ccho);
 	}
 	virtual void releaseResources() override
 	{
-		mCore->Unprepare();
+		mCore.Unprepare();
 		// DBG("[VocoderAudioProcessor] release");
 	}
 	virtual void processBlock(AudioSampleBuffer& asb, MidiBuffer& mb) override
 	{
 		juce::ScopedNoDenormals noDenormals;
-		mCore->Process(asb, mb);
+		RTSafety::ScopedRealtime rt;
+		mCore.Process(asb.getArrayOfWritePointers(), asb.getNumChannels(), asb.getNumSamples(), mb);
 	}
 	// editor
 	virtual AudioProcessorEditor* createEditor() override
@@ -297,15 +146,38 @@ public:
 	virtual bool isMidiEffect() const override { return false; }
 	virtual double getTailLengthSeconds() const override { return 0; }
 	// persistences
-	virtual int getNumPrograms() override { return 1; }
-	virtual int getCurrentProgram() override { return 0; }
-	virtual void setCurrentProgram(int) override {}
-	virtual const String getProgramName(int) override { return {}; }
+	virtual int getNumPrograms() override { return mCore.GetProgramCount(); }
+	virtual int getCurrentProgram() override { return mCore.GetProgram(); }
+	virtual void setCurrentProgram(int i) override { mCore.SelectProgram(i); }
+	virtual const String getProgramName(int i) override { return String::fromUTF8(mCore.GetProgramName(i)); }
 	virtual void changeProgramName(int, const String&) override {}
-	virtual void getStateInformation(MemoryBlock&) override {}
-	virtual void setStateInformation(const void*, int) override {}
+	virtual void getStateInformation(MemoryBlock& mb) override
+	{
+		mb.setSize(VocoderCore::StateSize());
+		mCore.SaveState((uint8_t*)mb.getData());
+	}
+	virtual void setStateInformation(const void* p, int cb) override
+	{
+		if(p && (0 < cb)) mCore.LoadState((const uint8_t*)p, (size_t)cb);
+	}
 	// external APIs
-	void getLevels(Levels* pv) const { mCore->GetLevels(pv); }
+	void getLevels(Levels* pv) const { mCore.GetLevels(pv); }
+	bool scheduleParameterChange(int ip, float v, int64_t sampletime) { return mCore.ScheduleParam(ip, v, sampletime); }
+	int64_t getSampleTime() const { return mCore.GetSampleTime(); }
+#if VOCODER_PROFILING
+	void getProfileStats(ProfileStats* pv) const { mCore.GetProfileStats(pv); }
+	void resetProfileStats() { mCore.ResetProfileStats(); }
+#endif
+#if VOCODER_DEADLINE_MONITOR
+	void getDeadlineStats(DeadlineStats* pv) const { mCore.GetDeadlineStats(pv); }
+	std::string getDeadlineStatsJSON() const { DeadlineStats st; mCore.GetDeadlineStats(&st); return DeadlineMonitor::ToJSON(st); }
+	void resetDeadlineStats() { mCore.ResetDeadlineStats(); }
+#endif
+#if VOCODER_TRACING
+	bool startTrace(const std::string& path) { return mCore.GetTracer().Start(path); }
+	void stopTrace() { mCore.GetTracer().Stop(); }
+	bool isTracing() const { return mCore.mTracer.IsEnabled(); }
+#endif
 };
 
 AudioProcessor* JUCE_CALLTYPE createPluginFilter()
@@ -10,30 +10,10 @@
 
 #include "JuceHeader.h"
 #include "FABB/ParamConvert.h"
+#include "VocoderCore.h"
 #include <array>
-
-struct ParamID
-{
-	enum
-	{
-		// instrument
-		InstPortamentoTime,
-		InstAttackTime,
-		InstReleaseTime,
-		InstLFORate,
-		InstModRange,
-		InstBendRange,
-		InstMonoMode,
-		// io
-		IOCarrierGain,
-		IOModulatorGain,
-		IOOutputGain,
-		// vocoder
-		VocNoiseGain,
-		VocBandShift,
-		Count,
-	};
-};
+#include <cstdint>
+#include <string>
 
 class VC1Core;
 
@@ -43,6 +23,33 @@ protected:
 	VocoderAudioProcessor(const BusesProperties& bp) : AudioProcessor(bp) {}
 public:
 	// external APIs
-	struct Levels { std::array<float, 3> ios; std::array<float, 16> modbands; };
+	// the meter snapshot, see VocoderLevels
+	using Levels = VocoderLevels;
 	virtual void getLevels(Levels* pv) const = 0;
+	// sample-accurate automation, see ParamScheduler
+	// the change is applied at the sample time counted from prepareToPlay(), deferred when closer than 32 samples to the previous one,
+	// so that the rendering does not depend on the block size of the host
+	// the host automation is applied at the block start instead, JUCE gives no sample time to AudioProcessorParameter::setValue()
+	// lock-free, for one producer thread at a time, in the time order, returns false when the queue is full
+	virtual bool scheduleParameterChange(int ip, float v, int64_t sampletime) = 0;
+	virtual int64_t getSampleTime() const = 0;
+#if VOCODER_PROFILING
+	// per-stage processing times, see ProcessProfiler
+	virtual void getProfileStats(ProfileStats* pv) const = 0;
+	virtual void resetProfileStats() = 0;
+#endif
+#if VOCODER_DEADLINE_MONITOR
+	// the block times against the real-time budget, see DeadlineMonitor
+	// can be polled from any thread, getDeadlineStatsJSON() is for the headless harnesses
+	virtual void getDeadlineStats(DeadlineStats* pv) const = 0;
+	virtual std::string getDeadlineStatsJSON() const = 0;
+	virtual void resetDeadlineStats() = 0;
+#endif
+#if VOCODER_TRACING
+	// records the processing stages into a Chrome trace JSON file until stopTrace(), see TraceRecorder
+	// not for the audio thread, returns false when the file cannot be opened
+	virtual bool startTrace(const std::string& path) = 0;
+	virtual void stopTrace() = 0;
+	virtual bool isTracing() const = 0;
+#endif
 };
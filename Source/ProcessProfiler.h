@@ -0,0 +1,116 @@
+//
+//  ProcessProfiler.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "FABB/TimeHistogram.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// per-stage timing of VocoderCore::Process
+// define VOCODER_PROFILING=1 in the project to enable the stage scopes and the histograms, otherwise they and their APIs are compiled out
+#ifndef VOCODER_PROFILING
+#define VOCODER_PROFILING 0
+#endif
+
+struct ProfileStage
+{
+	enum
+	{
+		Params, // parameter changes and MIDI events
+		Instrument, // on the helper thread when rendered in parallel
+		Analysis, // when the instrument is rendered in parallel, otherwise fused into Synthesis
+		Synthesis,
+		IO, // gain stages and meters
+		Total, // the whole block
+		Count,
+	};
+	static const char* Name(int i)
+	{
+		static const char* const Names[Count] = { "Params", "Instrument", "Analysis", "Synthesis", "IO", "Total" };
+		return ((0 <= i) && (i < Count)) ? Names[i] : "";
+	}
+};
+
+struct ProfileStats
+{
+	std::array<FABB::TimeHistogram::Stats, ProfileStage::Count> stages; // in nanoseconds
+};
+
+// the stage times are summed up in the block, and then added to the histograms at the block end
+// mBlockTimes holds the breakdown of the last block until the next BeginBlock()
+// the stages are timed by the audio thread, except for Instrument which may be timed by the helper thread,
+// the dispatch and the join of the helper thread order the accesses
+class ProcessProfiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+#if VOCODER_PROFILING
+	std::array<FABB::TimeHistogram, ProfileStage::Count> mHistograms;
+#endif
+	std::array<uint64_t, ProfileStage::Count> mBlockTimes;
+	std::atomic<bool> mResetRequest;
+	ProcessProfiler()
+	{
+		mBlockTimes.fill(0);
+		mResetRequest = false;
+	}
+	static uint64_t Now()
+	{
+		return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+	}
+	// can be called from any thread, the histograms are cleared by the audio thread at the next block
+	void RequestReset()
+	{
+		mResetRequest.store(true, std::memory_order_relaxed);
+	}
+	// returns the start time of the block
+	uint64_t BeginBlock()
+	{
+#if VOCODER_PROFILING
+		if(mResetRequest.exchange(false, std::memory_order_relaxed)) { for(auto&& h : mHistograms) h.Reset(); }
+#endif
+		mBlockTimes.fill(0);
+		return Now();
+	}
+	void AddTime(int stage, uint64_t ns)
+	{
+		mBlockTimes[stage] += ns;
+	}
+	void EndBlock(uint64_t start)
+	{
+		mBlockTimes[ProfileStage::Total] = Now() - start;
+#if VOCODER_PROFILING
+		for(int i = 0; i < ProfileStage::Count; i ++) mHistograms[i].Add(mBlockTimes[i]);
+#endif
+	}
+#if VOCODER_PROFILING
+	void GetStats(ProfileStats* pv) const
+	{
+		for(int i = 0; i < ProfileStage::Count; i ++) mHistograms[i].GetStats(&pv->stages[i]);
+	}
+#endif
+	// times a stage until the end of the scope
+	class Scope
+	{
+	public:
+		ProcessProfiler& mProfiler;
+		int mStage;
+		uint64_t mStart;
+		Scope(ProcessProfiler& p, int stage) : mProfiler(p), mStage(stage), mStart(Now()) {}
+		~Scope() { mProfiler.AddTime(mStage, Now() - mStart); }
+	};
+};
+
+#if VOCODER_PROFILING
+#define VOCODER_PROFILE_SCOPE(profiler, stage) ProcessProfiler::Scope profileScope_##stage(profiler, ProfileStage::stage)
+#else
+#define VOCODER_PROFILE_SCOPE(profiler, stage)
+#endif
@@ -10,14 +10,14 @@
 
 #include "FABB/CurveMapping.h"
 #include "FABB/ApproxCR.h"
-#include "FABB/SineOscillator.h"
+#include "FABB/ControlLFO.h"
+#include "FABB/ParamSmoother.h"
 #include "FABB/BlitOscillator.h"
+#include "FABB/FixedVector.h"
 #include <cmath>
 #include <cfloat>
 #include <algorithm>
-#include <list>
-#include <memory>
-#include <vector>
+#include <array>
 
 class EnvelopeAR
 {
@@ -63,23 +63,37 @@ public:
 	}
 };
 
+// a voice with up to MaxUnison detuned sub-voices
+// the sub-voices are rendered as the lanes of a BLIT oscillator bank, which always uses the fast math policy, whatever MathPolicyDefault is,
+// so that the lanes are vectorized in the product, the approximated sine is accurate relatively around the zeros of the BLIT denominator
+// the stereo spread is only heard through the stereo Process(), the vocoder core renders the carrier in mono
 class PulseVoice
 {
 public:
-	const FABB::CurveMapExponentialF& mPitchMap;
-	FABB::BlitOscillatorF mOsc;
+	enum { MaxUnison = 8 };
+	using OscillatorBank = FABB::BlitOscillatorBankT<float, MaxUnison, FABB::MathPolicyFast>;
+	const FABB::CurveMapExponentialF* mPitchMap; // owned by the instrument
+	OscillatorBank mOsc;
 	EnvelopeAR mEnv;
 	FABB::LagFilterF mPortaLag;
+	alignas(32) float mLanes[MaxUnison];
+	alignas(32) float mRatios[MaxUnison]; // frequency ratio of each sub-voice
+	alignas(32) float mGainsM[MaxUnison], mGainsL[MaxUnison], mGainsR[MaxUnison];
 	int mNote;
 	float mPitchMod;
-	PulseVoice(const FABB::CurveMapExponentialF& pitchmap) : mPitchMap(pitchmap), mNote(-1)
+	PulseVoice() : mPitchMap(nullptr), mNote(-1)
 	{
 		SetPortamentoTC(1);
 		SetAttackTC(1);
 		SetReleaseTC(1);
 		SetPitchMod(0);
+		SetUnison(1, 0, 0);
 		Reset();
 	}
+	void SetPitchMap(const FABB::CurveMapExponentialF* v)
+	{
+		mPitchMap = v;
+	}
 	void SetPortamentoTC(float v)
 	{
 		mPortaLag.SetTC(v);
@@ -96,6 +110,32 @@ public:
 	{
 		mPitchMod = v;
 	}
+	// count: number of sub-voices [1~MaxUnison]
+	// detune: pitch difference between the outermost sub-voice and the center, in semitones
+	// spread: stereo width [0~1]
+	void SetUnison(int count, float detune, float spread)
+	{
+		mOsc.SetCount(count);
+		int n = mOsc.GetCount();
+		float gain = 1 / std::sqrt((float)n);
+		for(int i = 0; i < n; i ++)
+		{
+			// position of the sub-voice [-1~1]
+			float pos = (1 < n) ? ((float)(2 * i) / (float)(n - 1) - 1) : 0;
+			mRatios[i] = std::pow(2.0f, detune * pos / 12.0f);
+			// linear pan law normalized to keep (L+R)/2 equal to the mono sum
+			float pan = spread * pos;
+			mGainsM[i] = gain;
+			mGainsL[i] = gain * (1 - pan);
+			mGainsR[i] = gain * (1 + pan);
+		}
+		// the idle lanes are still computed by the oscillator bank in the last group, keep them at a valid frequency
+		for(int i = n; i < MaxUnison; i ++)
+		{
+			mRatios[i] = 1;
+			mGainsM[i] = mGainsL[i] = mGainsR[i] = 0;
+		}
+	}
 	void Reset()
 	{
 		mOsc.Reset();
@@ -105,7 +145,7 @@ public:
 	void NoteOn(int v, int vstart)
 	{
 		mNote = v;
-		if(0 <= vstart) mPortaLag.Reset(mPitchMap.Map((float)vstart + mPitchMod));
+		if(0 <= vstart) mPortaLag.Reset(mPitchMap->Map((float)vstart + mPitchMod));
 		mEnv.GateOn();
 	}
 	void NoteOff()
@@ -120,69 +160,111 @@ public:
 	{
 		return mNote;
 	}
-	float process()
+	// renders the sub-voices into mLanes, and returns the envelope value
+	float internalProcessLanes()
 	{
-		mOsc.SetFreq(mPortaLag.Process(mPitchMap.Map((float)mNote + mPitchMod)));
-		float v = mEnv.Process() * mOsc.Process();
+		mOsc.SetFreqs(mPortaLag.Process(mPitchMap->Map((float)mNote + mPitchMod)), mRatios);
+		mOsc.Process(mLanes);
+		float e = mEnv.Process();
 		if(!mEnv.IsSounding()) mNote = -1;
-		return v;
+		return e;
+	}
+	float process()
+	{
+		float e = internalProcessLanes();
+		float v = 0;
+		for(int c = mOsc.GetCount(), i = 0; i < c; i ++) v += mLanes[i] * mGainsM[i];
+		return e * v;
+	}
+	void process(float* pl, float* pr)
+	{
+		float e = internalProcessLanes();
+		float vl = 0, vr = 0;
+		for(int c = mOsc.GetCount(), i = 0; i < c; i ++)
+		{
+			vl += mLanes[i] * mGainsL[i];
+			vr += mLanes[i] * mGainsR[i];
+		}
+		*pl = e * vl;
+		*pr = e * vr;
 	}
 };
 
+// the voices and the lists are stored inline, so that the instrument is one contiguous object and never allocates
+// not copyable nor movable, as the voices point to mPitchMap, and the lists point to mVoices
 class PulseInstrument
 {
 public:
 	enum { NumVoices = 8, MonoMaxStack = 3 };
 	using Voice = PulseVoice;
-	using VoicePtr = std::shared_ptr<PulseVoice>;
+	using VoiceList = FABB::FixedVectorT<Voice*, NumVoices>;
 	FABB::CurveMapExponentialF mPitchMap;
-	FABB::SineOscillatorF mLFO;
-	std::vector<VoicePtr> mVoices;
-	std::vector<Voice*> mIdleVoices, mActiveVoices;
-	std::vector<int> mNoteStack;
+	FABB::ControlLFOF mLFO; // evaluated at control-rate
+	std::array<Voice, NumVoices> mVoices;
+	VoiceList mIdleVoices, mActiveVoices;
+	FABB::FixedVectorT<int, MonoMaxStack + 1> mNoteStack;
 	float mPortamentTime, mAttackTime, mReleaseTime, mLFORate, mModRange, mBendRange;
-	float mLFOModCtrl, mPitchBendCtrl;
+	FABB::LinearRampF mLFOModCtrl, mPitchBendCtrl;
 	float mSampleRate;
+	int mUnisonCount;
+	float mUnisonDetune, mUnisonSpread;
 	bool mMonoMode;
 	PulseInstrument()
 	{
+		mUnisonCount = 1;
+		mUnisonDetune = 0.0f;
+		mUnisonSpread = 0.0f;
 		mPortamentTime = 0.01f;
 		mAttackTime = 0.01f;
 		mReleaseTime = 0.01f;
 		mLFORate = 1.0f;
 		mModRange = 2.0f;
 		mBendRange = 2.0f;
-		mLFOModCtrl = 0.0f;
-		mPitchBendCtrl = 0.0f;
+		mLFOModCtrl.Reset(0.0f);
+		mPitchBendCtrl.Reset(0.0f);
 		mSampleRate = 44100.0f;
 		mMonoMode = false;
-		mVoices.reserve(NumVoices);
-		mIdleVoices.reserve(NumVoices);
-		mActiveVoices.reserve(NumVoices);
-		for(int i = 0; i < NumVoices; i ++) mVoices.push_back(std::make_shared<PulseVoice>(mPitchMap));
-		mNoteStack.reserve(MonoMaxStack + 1);
+		for(auto&& voice : mVoices) voice.SetPitchMap(&mPitchMap);
 		Reset();
 	}
+	PulseInstrument(const PulseInstrument&) = delete;
+	PulseInstrument& operator=(const PulseInstrument&) = delete;
 	void SetPortamentoTime(float v)
 	{
 		mPortamentTime = v;
-		for(auto&& voice : mVoices) voice->SetPortamentoTC(mPortamentTime * mSampleRate);
+		for(auto&& voice : mVoices) voice.SetPortamentoTC(mPortamentTime * mSampleRate);
 	}
 	void SetAttackTime(float v)
 	{
 		mAttackTime = v;
-		for(auto&& voice : mVoices) voice->SetAttackTC(mAttackTime * mSampleRate);
+		for(auto&& voice : mVoices) voice.SetAttackTC(mAttackTime * mSampleRate);
 	}
 	void SetReleaseTime(float v)
 	{
 		mReleaseTime = v;
-		for(auto&& voice : mVoices) voice->SetReleaseTC(mReleaseTime * mSampleRate);
+		for(auto&& voice : mVoices) voice.SetReleaseTC(mReleaseTime * mSampleRate);
 	}
 	void SetLFORate(float v)
 	{
 		mLFORate = v;
 		mLFO.SetFreq(mLFORate / mSampleRate);
 	}
+	void SetUnisonCount(int v)
+	{
+		mUnisonCount = v;
+		for(auto&& voice : mVoices) voice.SetUnison(mUnisonCount, mUnisonDetune, mUnisonSpread);
+	}
+	// in semitones
+	void SetUnisonDetune(float v)
+	{
+		mUnisonDetune = v;
+		for(auto&& voice : mVoices) voice.SetUnison(mUnisonCount, mUnisonDetune, mUnisonSpread);
+	}
+	void SetUnisonSpread(float v)
+	{
+		mUnisonSpread = v;
+		for(auto&& voice : mVoices) voice.SetUnison(mUnisonCount, mUnisonDetune, mUnisonSpread);
+	}
 	void SetModRange(float v)
 	{
 		mModRange = v;
@@ -193,11 +275,20 @@ public:
 	}
 	void SetLFOModCtrl(float v)
 	{
-		mLFOModCtrl = v;
+		mLFOModCtrl.Reset(v);
 	}
 	void SetPitchBendCtrl(float v)
 	{
-		mPitchBendCtrl = v;
+		mPitchBendCtrl.Reset(v);
+	}
+	// reaches the value linearly at the l-th sample
+	void RampLFOModCtrl(float v, int l)
+	{
+		mLFOModCtrl.SetTarget(v, l);
+	}
+	void RampPitchBendCtrl(float v, int l)
+	{
+		mPitchBendCtrl.SetTarget(v, l);
 	}
 	void setMonoMode(bool v)
 	{
@@ -214,9 +305,9 @@ public:
 		mLFO.SetFreq(mLFORate / mSampleRate);
 		for(auto&& voice : mVoices)
 		{
-			voice->SetPortamentoTC(mPortamentTime * mSampleRate);
-			voice->SetAttackTC(mAttackTime * mSampleRate);
-			voice->SetReleaseTC(mReleaseTime * mSampleRate);
+			voice.SetPortamentoTC(mPortamentTime * mSampleRate);
+			voice.SetAttackTC(mAttackTime * mSampleRate);
+			voice.SetReleaseTC(mReleaseTime * mSampleRate);
 		}
 		Reset();
 	}
@@ -226,14 +317,15 @@ public:
 	void Reset()
 	{
 		mLFO.Reset();
-		mActiveVoices.resize(0);
-		mIdleVoices.resize(0);
-		for(auto&& voice : mVoices) mIdleVoices.push_back(voice.get());
-		mNoteStack.resize(0);
+		mActiveVoices.clear();
+		mIdleVoices.clear();
+		for(auto&& voice : mVoices) mIdleVoices.push_back(&voice);
+		mNoteStack.clear();
 	}
 	void NoteOn(int v)
 	{
 		mNoteStack.erase(std::remove(mNoteStack.begin(), mNoteStack.end(), v), mNoteStack.end());
+		if(mNoteStack.full()) mNoteStack.erase(mNoteStack.begin()); // keeps the latest notes in the poly mode too
 		mNoteStack.push_back(v);
 		if(mMonoMode)
 		{
@@ -250,8 +342,8 @@ public:
 		}
 		else
 		{
-			std::vector<Voice*>* arr = nullptr;
-			std::vector<Voice*>::iterator it = std::find_if(mActiveVoices.begin(), mActiveVoices.end(), [v](const Voice* voice) { return voice->Note() == v; });
+			VoiceList* arr = nullptr;
+			VoiceList::iterator it = std::find_if(mActiveVoices.begin(), mActiveVoices.end(), [v](const Voice* voice) { return voice->Note() == v; });
 			if(it != mActiveVoices.end()) { arr = &mActiveVoices; }
 			else if(mIdleVoices.empty()) { it = mActiveVoices.begin(); arr = &mActiveVoices; }
 			else { it = mIdleVoices.begin(); arr = &mIdleVoices; }
@@ -279,21 +371,40 @@ public:
 			if(it != mActiveVoices.end()) (*it)->NoteOff();
 		}
 	}
+	void internalReleaseIdleVoices()
+	{
+		VoiceList::iterator i = mActiveVoices.begin(); while(i != mActiveVoices.end())
+		{
+			if((*i)->IsSounding()) i ++;
+			else { Voice* voice = *i; i = mActiveVoices.erase(i); mIdleVoices.push_back(voice); }
+		}
+	}
 	float internalRawProcess()
 	{
-		float mod = mLFO.Process() * mModRange * mLFOModCtrl + mBendRange * mPitchBendCtrl;
+		float mod = mLFO.Process() * mModRange * mLFOModCtrl.Process() + mBendRange * mPitchBendCtrl.Process();
 		float v = 0;
 		for(auto&& voice : mActiveVoices)
 		{
 			voice->SetPitchMod(mod);
 			v += voice->process();
 		}
-		std::vector<Voice*>::iterator i = mActiveVoices.begin(); while(i != mActiveVoices.end())
+		internalReleaseIdleVoices();
+		return v;
+	}
+	void internalRawProcess(float* pl, float* pr)
+	{
+		float mod = mLFO.Process() * mModRange * mLFOModCtrl.Process() + mBendRange * mPitchBendCtrl.Process();
+		float vl = 0, vr = 0;
+		for(auto&& voice : mActiveVoices)
 		{
-			if((*i)->IsSounding()) i ++;
-			else { Voice* voice = *i; i = mActiveVoices.erase(i); mIdleVoices.push_back(voice); }
+			voice->SetPitchMod(mod);
+			float l, r; voice->process(&l, &r);
+			vl += l;
+			vr += r;
 		}
-		return v;
+		internalReleaseIdleVoices();
+		*pl = vl;
+		*pr = vr;
 	}
 	void Process(float* p, int l)
 	{
@@ -303,4 +414,13 @@ public:
 	{
 		while(l --) *p ++ += internalRawProcess();
 	}
+	// stereo rendering with the unison spread, (L+R)/2 equals to the mono rendering
+	void Process(float* pl, float* pr, int l)
+	{
+		while(l --) internalRawProcess(pl ++, pr ++);
+	}
+	void ProcessAdd(float* pl, float* pr, int l)
+	{
+		while(l --) { float vl, vr; internalRawProcess(&vl, &vr); *pl ++ += vl; *pr ++ += vr; }
+	}
 };
@@ -0,0 +1,198 @@
+//
+//  RTSafetyChecker.cpp
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#include "RTSafetyChecker.h"
+
+#if VOCODER_RTCHECK
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+#endif
+
+namespace RTSafety
+{
+
+	// the thread locals are trivial, so that accessing them from the hooks never allocates
+	static thread_local int tRealtimeDepth = 0;
+	static thread_local int tAllowDepth = 0;
+	static thread_local bool tInReport = false;
+	static std::atomic<uint64_t> gViolationCount(0);
+
+	void EnterRealtime() { tRealtimeDepth ++; }
+	void LeaveRealtime() { tRealtimeDepth --; }
+	bool IsRealtime() { return 0 < tRealtimeDepth; }
+	void EnterAllowed() { tAllowDepth ++; }
+	void LeaveAllowed() { tAllowDepth --; }
+	uint64_t GetViolationCount() { return gViolationCount.load(std::memory_order_relaxed); }
+	void ResetViolationCount() { gViolationCount.store(0, std::memory_order_relaxed); }
+
+	void ReportViolation(const char* what)
+	{
+		tInReport = true; // the reporting itself may allocate
+		uint64_t n = gViolationCount.fetch_add(1, std::memory_order_relaxed) + 1;
+		if(n <= MaxReports)
+		{
+			std::fprintf(stderr, "[RTSafety] violation #%llu: %s in the real-time scope\n", (unsigned long long)n, what);
+			void* frames[32];
+#if defined(_WIN32)
+			int c = (int)CaptureStackBackTrace(1, 32, frames, nullptr);
+			for(int i = 0; i < c; i ++) std::fprintf(stderr, "  #%d %p\n", i, frames[i]);
+#else
+			int c = backtrace(frames, 32);
+			std::fflush(stderr);
+			backtrace_symbols_fd(frames + 1, c - 1, 2);
+#endif
+			if(n == MaxReports) std::fprintf(stderr, "[RTSafety] further violations are only counted\n");
+		}
+		tInReport = false;
+	}
+
+	static inline void internalCheck(const char* what)
+	{
+		if((0 < tRealtimeDepth) && (tAllowDepth == 0) && !tInReport) ReportViolation(what);
+	}
+
+} // namespace RTSafety
+
+#if defined(__GLIBC__)
+
+// interposes the allocator, which covers operator new/delete and the C libraries
+extern "C"
+{
+	void* __libc_malloc(size_t);
+	void* __libc_calloc(size_t, size_t);
+	void* __libc_realloc(void*, size_t);
+	void* __libc_memalign(size_t, size_t);
+	void* __libc_valloc(size_t);
+	void* __libc_pvalloc(size_t);
+	void __libc_free(void*);
+
+	void* malloc(size_t n)
+	{
+		RTSafety::internalCheck("malloc");
+		return __libc_malloc(n);
+	}
+	void* calloc(size_t c, size_t n)
+	{
+		RTSafety::internalCheck("calloc");
+		return __libc_calloc(c, n);
+	}
+	void* realloc(void* p, size_t n)
+	{
+		RTSafety::internalCheck("realloc");
+		return __libc_realloc(p, n);
+	}
+	void* memalign(size_t a, size_t n)
+	{
+		RTSafety::internalCheck("memalign");
+		return __libc_memalign(a, n);
+	}
+	void* valloc(size_t n)
+	{
+		RTSafety::internalCheck("valloc");
+		return __libc_valloc(n);
+	}
+	void* pvalloc(size_t n)
+	{
+		RTSafety::internalCheck("pvalloc");
+		return __libc_pvalloc(n);
+	}
+	void* aligned_alloc(size_t a, size_t n)
+	{
+		RTSafety::internalCheck("aligned_alloc");
+		return __libc_memalign(a, n);
+	}
+	int posix_memalign(void** pp, size_t a, size_t n)
+	{
+		RTSafety::internalCheck("posix_memalign");
+		void* p = __libc_memalign(a, n);
+		if(!p) return 12; // ENOMEM
+		*pp = p;
+		return 0;
+	}
+	void free(void* p)
+	{
+		if(p) RTSafety::internalCheck("free");
+		__libc_free(p);
+	}
+}
+
+#else
+
+// replaces operator new/delete
+void* operator new(std::size_t n)
+{
+	RTSafety::internalCheck("operator new");
+	if(void* p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t n)
+{
+	RTSafety::internalCheck("operator new[]");
+	if(void* p = std::malloc(n ? n : 1)) return p;
+	throw std::bad_alloc();
+}
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+	RTSafety::internalCheck("operator new");
+	return std::malloc(n ? n : 1);
+}
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept
+{
+	RTSafety::internalCheck("operator new[]");
+	return std::malloc(n ? n : 1);
+}
+void operator delete(void* p) noexcept
+{
+	if(p) RTSafety::internalCheck("operator delete");
+	std::free(p);
+}
+void operator delete[](void* p) noexcept
+{
+	if(p) RTSafety::internalCheck("operator delete[]");
+	std::free(p);
+}
+void operator delete(void* p, std::size_t) noexcept
+{
+	if(p) RTSafety::internalCheck("operator delete");
+	std::free(p);
+}
+void operator delete[](void* p, std::size_t) noexcept
+{
+	if(p) RTSafety::internalCheck("operator delete[]");
+	std::free(p);
+}
+
+#endif
+
+#if !defined(_WIN32)
+// interposes the mutex, the original is looked up lazily without any lock
+extern "C" int pthread_mutex_lock(pthread_mutex_t* m)
+{
+	using Fn = int(*)(pthread_mutex_t*);
+	static std::atomic<Fn> sReal(nullptr);
+	Fn fn = sReal.load(std::memory_order_acquire);
+	if(!fn)
+	{
+		fn = (Fn)dlsym(RTLD_NEXT, "pthread_mutex_lock");
+		sReal.store(fn, std::memory_order_release);
+	}
+	RTSafety::internalCheck("pthread_mutex_lock");
+	return fn(m);
+}
+#endif
+
+#endif // VOCODER_RTCHECK
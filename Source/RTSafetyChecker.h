@@ -0,0 +1,65 @@
+//
+//  RTSafetyChecker.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cstdint>
+
+// real-time safety checker for the debug and the test builds
+// define VOCODER_RTCHECK=1 in the project to enable, otherwise everything is compiled out
+// while a thread is in a real-time scope, the memory allocations and the mutex acquisitions are reported to stderr with the stack traces
+// - glibc: malloc, calloc, realloc, memalign, valloc, pvalloc, aligned_alloc, posix_memalign, free and pthread_mutex_lock are interposed
+// - other POSIX: operator new/delete are replaced, and pthread_mutex_lock is interposed
+// - Windows: operator new/delete are replaced, the locks are not detected
+// the interposition takes effect in the executables which link the processor statically, i.e. the Standalone build and the test harnesses (see Tests/RTSafetyTest.cpp),
+// the plugin binaries loaded by a host keep using the host's allocator
+#ifndef VOCODER_RTCHECK
+#define VOCODER_RTCHECK 0
+#endif
+
+namespace RTSafety
+{
+
+	enum { MaxReports = 16 }; // the stack traces are printed for the first reports, the rest are only counted
+
+#if VOCODER_RTCHECK
+	void EnterRealtime();
+	void LeaveRealtime();
+	bool IsRealtime();
+	// for the known and accepted operations in a real-time scope
+	void EnterAllowed();
+	void LeaveAllowed();
+	void ReportViolation(const char* what);
+	uint64_t GetViolationCount();
+	void ResetViolationCount();
+#else
+	inline void EnterRealtime() {}
+	inline void LeaveRealtime() {}
+	inline bool IsRealtime() { return false; }
+	inline void EnterAllowed() {}
+	inline void LeaveAllowed() {}
+	inline void ReportViolation(const char*) {}
+	inline uint64_t GetViolationCount() { return 0; }
+	inline void ResetViolationCount() {}
+#endif
+
+	class ScopedRealtime
+	{
+	public:
+		ScopedRealtime() { EnterRealtime(); }
+		~ScopedRealtime() { LeaveRealtime(); }
+	};
+
+	class ScopedAllow
+	{
+	public:
+		ScopedAllow() { EnterAllowed(); }
+		~ScopedAllow() { LeaveAllowed(); }
+	};
+
+} // namespace RTSafety
@@ -0,0 +1,197 @@
+//
+//  TraceRecorder.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "ProcessProfiler.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// records the processing stages as the complete events, and writes them as a Chrome trace JSON file (chrome://tracing, Perfetto)
+// the recording is off until Start(), define VOCODER_TRACING=0 in the project to compile it out
+#ifndef VOCODER_TRACING
+#define VOCODER_TRACING 1
+#endif
+
+// - every recording thread has its own preallocated single-producer ring, the audio thread and the helper thread,
+//   so that recording an event is wait-free and never allocates, the events are dropped when the ring is full
+// - a stage is written as one 'X' event with the start and the duration at the end of the scope,
+//   so that a dropped event or a restart of the recording never leaves an unmatched begin or end in the trace
+// - a background thread drains the rings and writes the file
+// - the rings are allocated at the first Start(), and kept until the destruction,
+//   so that a scope in flight while stopping never touches freed memory
+class TraceRecorder
+{
+public:
+	enum { AudioSlot, HelperSlot, SlotCount };
+	enum { RingSize = 1 << 16, FlushIntervalMs = 20 };
+	// the stage names are taken from ProfileStage, Total is recorded as processBlock
+	struct Event
+	{
+		uint64_t time, duration;
+		uint16_t name;
+		uint8_t slot;
+	};
+	struct Ring
+	{
+		std::vector<Event> events;
+		std::atomic<uint32_t> head, tail; // written by the producer and the consumer respectively
+		std::atomic<uint32_t> dropped;
+		Ring() : head(0), tail(0), dropped(0) {}
+	};
+	Ring mRings[SlotCount];
+	std::atomic<bool> mEnabled;
+	std::atomic<uint32_t> mSession; // counts Start(), so that a scope open across a restart is not recorded
+	std::atomic<bool> mRunning;
+	std::thread mFlushThread;
+	FILE* mFile;
+	uint64_t mOrigin;
+	bool mFirstEvent;
+	TraceRecorder()
+	{
+		mEnabled = false;
+		mSession = 0;
+		mRunning = false;
+		mFile = nullptr;
+		mOrigin = 0;
+		mFirstEvent = true;
+	}
+	~TraceRecorder()
+	{
+		Stop();
+	}
+	static uint64_t Now()
+	{
+		return ProcessProfiler::Now();
+	}
+	// the slot of the calling thread, AudioSlot unless set
+	static int& internalThreadSlot()
+	{
+		static thread_local int slot = AudioSlot;
+		return slot;
+	}
+	static void SetThreadSlot(int v)
+	{
+		internalThreadSlot() = v;
+	}
+	static const char* EventName(int i)
+	{
+		return (i == ProfileStage::Total) ? "processBlock" : ProfileStage::Name(i);
+	}
+	// not for the audio thread, returns false when the file cannot be opened
+	bool Start(const std::string& path)
+	{
+		Stop();
+		mFile = std::fopen(path.c_str(), "w");
+		if(!mFile) return false;
+		std::fputs("[\n", mFile);
+		mFirstEvent = true;
+		mOrigin = Now();
+		for(auto&& r : mRings)
+		{
+			if(r.events.empty()) r.events.resize(RingSize);
+			r.tail.store(r.head.load(std::memory_order_acquire), std::memory_order_relaxed);
+			r.dropped.store(0, std::memory_order_relaxed);
+		}
+		mRunning = true;
+		mFlushThread = std::thread([this]() { internalFlushLoop(); });
+		mSession.fetch_add(1, std::memory_order_relaxed);
+		mEnabled.store(true, std::memory_order_release);
+		return true;
+	}
+	// not for the audio thread, writes the remaining events and closes the file
+	void Stop()
+	{
+		mEnabled.store(false, std::memory_order_relaxed);
+		if(mFlushThread.joinable())
+		{
+			mRunning = false;
+			mFlushThread.join();
+		}
+		if(mFile)
+		{
+			internalDrain();
+			std::fputs("\n]\n", mFile);
+			std::fclose(mFile);
+			mFile = nullptr;
+		}
+	}
+	bool IsEnabled() const
+	{
+		return mEnabled.load(std::memory_order_acquire);
+	}
+	uint32_t GetDroppedCount() const
+	{
+		uint32_t n = 0;
+		for(auto&& r : mRings) n += r.dropped.load(std::memory_order_relaxed);
+		return n;
+	}
+	// wait-free, for the recording threads, start is given by Now()
+	void Add(int name, uint64_t start, uint64_t duration)
+	{
+		Ring& r = mRings[internalThreadSlot()];
+		uint32_t h = r.head.load(std::memory_order_relaxed);
+		uint32_t t = r.tail.load(std::memory_order_acquire);
+		if(RingSize <= (h - t)) { r.dropped.fetch_add(1, std::memory_order_relaxed); return; }
+		r.events[h & (RingSize - 1)] = { start, duration, (uint16_t)name, (uint8_t)internalThreadSlot() };
+		r.head.store(h + 1, std::memory_order_release);
+	}
+	// records a stage until the end of the scope, when the same recording is on at both ends
+	class Scope
+	{
+	public:
+		TraceRecorder& mRecorder;
+		int mName;
+		uint32_t mSession; // 0 when the recording is off at the beginning
+		uint64_t mStart;
+		Scope(TraceRecorder& r, int name) : mRecorder(r), mName(name), mSession(r.internalSession()), mStart(mSession ? Now() : 0) {}
+		~Scope() { if(mSession && (mRecorder.internalSession() == mSession)) mRecorder.Add(mName, mStart, Now() - mStart); }
+	};
+	// for the internal use
+	// the current recording, or 0 when off
+	uint32_t internalSession() const
+	{
+		return IsEnabled() ? mSession.load(std::memory_order_relaxed) : 0;
+	}
+	void internalFlushLoop()
+	{
+		while(mRunning)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(FlushIntervalMs));
+			internalDrain();
+		}
+	}
+	void internalDrain()
+	{
+		for(auto&& r : mRings)
+		{
+			uint32_t t = r.tail.load(std::memory_order_relaxed);
+			uint32_t h = r.head.load(std::memory_order_acquire);
+			for(; t != h; t ++)
+			{
+				const Event& ev = r.events[t & (RingSize - 1)];
+				double ts = (double)(int64_t)(ev.time - mOrigin) * 1e-3;
+				std::fprintf(mFile, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}", mFirstEvent ? "" : ",\n", EventName(ev.name), ts, (double)ev.duration * 1e-3, (int)ev.slot + 1);
+				mFirstEvent = false;
+			}
+			r.tail.store(t, std::memory_order_release);
+		}
+		std::fflush(mFile);
+	}
+};
+
+#if VOCODER_TRACING
+#define VOCODER_TRACE_SCOPE(recorder, stage) TraceRecorder::Scope traceScope_##stage(recorder, ProfileStage::stage)
+#else
+#define VOCODER_TRACE_SCOPE(recorder, stage)
+#endif
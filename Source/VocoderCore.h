@@ -0,0 +1,613 @@
+//
+//  VocoderCore.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "VocoderParams.h"
+#include "PulseInstrument.h"
+#include "InstrumentScheduler.h"
+#include "ParamScheduler.h"
+#include "ProcessProfiler.h"
+#include "DeadlineMonitor.h"
+#include "TraceRecorder.h"
+#include "WorkerThread.h"
+#include "RTSafetyChecker.h"
+#include "ChannelVocoder.h"
+#include "FABB/Arena.h"
+#include "FABB/BlockMeter.h"
+#include "FABB/GainStage.h"
+#include "FABB/ParamConvert.h"
+#include "FABB/ParamMap.h"
+#include "FABB/ParamSmoother.h"
+#include "FABB/SeqLock.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+// the meter snapshot, published by the audio thread at the block end, and read without locking
+// ios: carrier, modulator, output envelopes
+// iopeaks, iorms: peak and RMS in the last block
+// modbands: band envelopes
+// modbandpeaks: band envelope peaks, held for a while and then decay
+// modbandrms: band RMS in the last block
+struct VocoderLevels
+{
+	std::array<float, 3> ios, iopeaks, iorms;
+	std::array<float, 16> modbands, modbandpeaks, modbandrms;
+};
+
+// the factory presets in the native values, in the order of ParamID
+// converted to the control values once by VocoderCore, so that a program change on the audio thread is a plain copy
+struct VocoderPreset
+{
+	const char* name;
+	float values[ParamID::Count];
+};
+inline const VocoderPreset gPresets[] =
+{
+	//					 IPT	IAT		IRT		ILR		IMR		IBR		IMM	IUC	IUD		CG		MG		OG		NG		BS
+	{ "Init",			{ 0.01f,	0.01f,	0.01f,	5,		2,		2,		1,	1,	0.1f,	2,		2,		2,		0.5f,	0 } },
+	{ "Robot",			{ 0.05f,	0.001f,	0.05f,	5,		0.5f,	2,		0,	1,	0,		2,		2,		2,		0.2f,	0 } },
+	{ "Choir",			{ 0.01f,	0.2f,	0.6f,	4,		0.3f,	2,		1,	4,	0.25f,	2,		2,		1.5f,	0.5f,	0 } },
+	{ "Whisper",		{ 0.01f,	0.05f,	0.3f,	5,		0,		2,		1,	1,	0.1f,	0,		2,		2,		10,		0 } },
+	{ "Low Formant",	{ 0.01f,	0.01f,	0.1f,	5,		2,		2,		1,	2,	0.15f,	2,		2,		2,		0.5f,	-2 } },
+	{ "High Formant",	{ 0.01f,	0.01f,	0.1f,	5,		2,		2,		1,	2,	0.15f,	2,		2,		2,		0.5f,	2 } },
+};
+
+// the block statistics are accumulated by the gain stage kernels, and the ballistics are applied once per block
+class LevelMeter : public FABB::BlockMeterF
+{
+public:
+	FABB::GainStage::Stats mStats; // in the last block
+};
+
+// times the stage for the profiler and the deadline monitor, and records it for the trace, until the end of the scope, compiled out unless enabled
+// only on the audio thread, as the monitor charges the stage with the time since the previous one, see StageLaps
+#define VOCODER_STAGE_SCOPE(stage) VOCODER_PROFILE_SCOPE(mProfiler, stage); VOCODER_TRACE_SCOPE(mTracer, stage); VOCODER_LAP_SCOPE(mStageLaps, stage)
+
+class VocoderCore
+{
+public:
+	// the instrument is rendered on the helper thread when the block is long enough to pay the handoff
+	enum { ParallelMinBlockSize = 256 };
+	enum { PresetCount = (int)(sizeof(gPresets) / sizeof(gPresets[0])) };
+	// the state chunk, little endian
+	// u32 magic "CVst", u16 version, u16 parameter count, i32 program, f32 control values[parameter count] in the order of ParamID
+	// the parameters missing in an older chunk are set to the defaults, the extra ones in a newer chunk are ignored,
+	// a newer version must keep the parameters of the older ones in their slots, and only append the new ones
+	enum : uint32_t { StateMagic = 0x74735643 };
+	enum { StateVersion = 1, StateHeaderSize = 12 };
+	static constexpr float GainSmoothingTC() { return 0.01f; }
+	// the members are grouped by the access pattern, the DSP state touched by every block comes first,
+	// the parameter chunk shared with the other threads is kept on its own cache lines, and the rarely touched state follows
+	// the hot DSP state
+	PulseInstrument mInstrument;
+	InstrumentScheduler mScheduler;
+	ChannelVocoder mVocoder;
+	FABB::GridSmootherF mCarrierGain, mModulatorGain, mOutputGain; // on the grid from Prepare(), see GridSmootherT
+	std::array<LevelMeter, 3> mIOMeters;
+	std::array<FABB::BlockMeterF, ChannelVocoder::BandCount> mBandPeaks;
+	FABB::Arena mArena; // the work buffers, reserved in Prepare()
+	float* mInstBuffer; // [mMaxBlockSize], the instrument, and then the carrier
+	int mMaxBlockSize;
+	int mNchC, mNchM, mNchO;
+	int mInstLength;
+	// written by any thread, and applied to the DSP objects on the audio thread at the block start
+	alignas(64) std::array<std::atomic<float>, ParamID::Count> mChunk;
+	alignas(64) std::atomic<uint32_t> mDirtyParams;
+	static_assert(ParamID::Count <= 32, "mDirtyParams has no room for the parameters");
+	ParamScheduler mParamScheduler; // the timestamped changes, queued by a control thread
+	// the program selected by any thread, swapped in on the audio thread at the block start, -1 when none
+	std::atomic<int> mPendingProgram;
+	std::atomic<int> mProgram;
+	// the parameters changed by the audio thread itself, i.e. by a program change, polled to notify the host and the editor
+	std::atomic<uint32_t> mChangedParams;
+	std::atomic<bool> mProgramChanged;
+	// the cold state
+	alignas(64) std::shared_ptr<const FABB::ParamConverterTable> mParamConverterTable; // shared by all the instances
+	std::array<std::array<float, ParamID::Count>, PresetCount> mPresetBank; // the control values of gPresets
+	std::unique_ptr<WorkerThread> mInstThread;
+	VocoderLevels mLevelsWork; // the snapshot being built by the audio thread
+	FABB::SeqLockT<VocoderLevels> mLevels;
+#if VOCODER_PROFILING
+	ProcessProfiler mProfiler;
+#endif
+#if VOCODER_DEADLINE_MONITOR
+	DeadlineMonitor mDeadlineMonitor;
+	StageLaps mStageLaps;
+#endif
+#if VOCODER_TRACING
+	TraceRecorder mTracer;
+#endif
+	VocoderCore()
+	{
+		mInstBuffer = nullptr;
+		mMaxBlockSize = 0;
+		mNchC = mNchM = mNchO = 0;
+		mInstLength = 0;
+		mDirtyParams = 0;
+		mChangedParams = 0;
+		mProgramChanged = false;
+		mLevelsWork = {};
+		mLevels.Store(mLevelsWork);
+		mParamConverterTable = FABB::ParamConverterTable::Share(gParamProfile, sizeof(gParamProfile) / sizeof(gParamProfile[0]));
+		assert(mParamConverterTable->Count() == ParamID::Count);
+		for(int ip = 0; ip < ParamID::Count; ip ++)
+		{
+			const FABB::ParamConverter* pc = (*mParamConverterTable)[ip];
+			mChunk[ip] = pc->ControlDef();
+			ApplyParam(ip, mChunk[ip]);
+			for(int ipg = 0; ipg < PresetCount; ipg ++) mPresetBank[ipg][ip] = pc->LimitControlValue(pc->NativeToControl(gPresets[ipg].values[ip]));
+		}
+		mPendingProgram = -1;
+		mProgram = 0;
+	}
+	const FABB::ParamConverter* GetParamConverter(int ip) const
+	{
+		return (*mParamConverterTable)[ip];
+	}
+	float GetParam(int ip) const
+	{
+		return mChunk[ip].load(std::memory_order_relaxed);
+	}
+	// lock-free, can be called from any thread, applied at the next block start as a whole, see ScheduleParam() for the sample-accurate changes
+	void SetParam(int ip, float v)
+	{
+		mChunk[ip].store(v, std::memory_order_relaxed);
+		mDirtyParams.fetch_or(1u << ip, std::memory_order_release);
+	}
+	// lock-free, for one producer thread at a time, the changes must be scheduled in the time order
+	// time: the sample time counted from Prepare(), the change is applied at that sample, or deferred by less than ParamScheduler::MinSegmentLength
+	bool ScheduleParam(int ip, float v, int64_t time)
+	{
+		if((ip < 0) || (ParamID::Count <= ip)) return false;
+		return mParamScheduler.Add(time, ip, v);
+	}
+	int64_t GetSampleTime() const
+	{
+		return mParamScheduler.GetTime();
+	}
+	// called on the audio thread at the block start
+	void ApplyParamChanges()
+	{
+		int ipg = mPendingProgram.exchange(-1, std::memory_order_acquire);
+		if(0 <= ipg) internalApplyProgram(ipg);
+		uint32_t dirty = mDirtyParams.exchange(0, std::memory_order_acquire);
+		for(int ip = 0; dirty != 0; ip ++, dirty >>= 1)
+		{
+			if(dirty & 1u) ApplyParam(ip, mChunk[ip].load(std::memory_order_relaxed));
+		}
+	}
+	// programs
+	int GetProgramCount() const
+	{
+		return PresetCount;
+	}
+	const char* GetProgramName(int i) const
+	{
+		return ((0 <= i) && (i < PresetCount)) ? gPresets[i].name : "";
+	}
+	int GetProgram() const
+	{
+		int i = mPendingProgram.load(std::memory_order_acquire);
+		return (0 <= i) ? i : mProgram.load(std::memory_order_relaxed);
+	}
+	// lock-free, can be called from any thread, the preset is swapped in on the audio thread at the next block start
+	void SelectProgram(int i)
+	{
+		if((0 <= i) && (i < PresetCount)) mPendingProgram.store(i, std::memory_order_release);
+	}
+	// on the audio thread, copies the preset into the parameters, and applies only the changed ones,
+	// so that the untouched DSP state is kept, and the gains move with the smoothers as usual
+	void internalApplyProgram(int i)
+	{
+		if((i < 0) || (PresetCount <= i)) return;
+		const std::array<float, ParamID::Count>& values = mPresetBank[i];
+		uint32_t changed = 0;
+		for(int ip = 0; ip < ParamID::Count; ip ++)
+		{
+			if(mChunk[ip].load(std::memory_order_relaxed) == values[ip]) continue;
+			mChunk[ip].store(values[ip], std::memory_order_relaxed);
+			ApplyParam(ip, values[ip]);
+			changed |= 1u << ip;
+		}
+		mProgram.store(i, std::memory_order_relaxed);
+		mChangedParams.fetch_or(changed, std::memory_order_release);
+		mProgramChanged.store(true, std::memory_order_release);
+	}
+	// lock-free, for the thread which notifies the host and the editor, e.g. the message thread
+	// returns the bits of the parameters changed by the program changes since the last call, in the order of ParamID
+	uint32_t TakeChangedParams()
+	{
+		return mChangedParams.exchange(0, std::memory_order_acquire);
+	}
+	// returns true when a program has been applied since the last call
+	bool TakeProgramChanged()
+	{
+		return mProgramChanged.exchange(false, std::memory_order_acquire);
+	}
+	// state
+	static size_t StateSize()
+	{
+		return StateHeaderSize + 4 * (size_t)ParamID::Count;
+	}
+	// writes StateSize() bytes, can be called from any thread
+	void SaveState(uint8_t* p) const
+	{
+		internalPut32(p, StateMagic);
+		internalPut16(p + 4, StateVersion);
+		internalPut16(p + 6, ParamID::Count);
+		internalPut32(p + 8, (uint32_t)GetProgram());
+		for(int ip = 0; ip < ParamID::Count; ip ++)
+		{
+			float v = GetParam(ip);
+			uint32_t u; std::memcpy(&u, &v, sizeof(u));
+			internalPut32(p + StateHeaderSize + 4 * (size_t)ip, u);
+		}
+	}
+	// lock-free, can be called from any thread, the parameters are applied at the next block start
+	// returns false when the chunk is not recognized, and leaves the state unchanged
+	bool LoadState(const uint8_t* p, size_t cb)
+	{
+		if((cb < StateHeaderSize) || (internalGet32(p) != StateMagic)) return false;
+		size_t c = internalGet16(p + 6);
+		if(cb < (StateHeaderSize + 4 * c)) return false;
+		mPendingProgram.store(-1, std::memory_order_relaxed);
+		for(int ip = 0; ip < ParamID::Count; ip ++)
+		{
+			const FABB::ParamConverter* pc = GetParamConverter(ip);
+			float v = pc->ControlDef();
+			if((size_t)ip < c)
+			{
+				uint32_t u = internalGet32(p + StateHeaderSize + 4 * (size_t)ip);
+				float vs; std::memcpy(&vs, &u, sizeof(vs));
+				if(std::isfinite(vs)) v = pc->LimitControlValue(vs);
+			}
+			SetParam(ip, v);
+		}
+		int ipg = (int)internalGet32(p + 8);
+		mProgram.store(((0 <= ipg) && (ipg < PresetCount)) ? ipg : 0, std::memory_order_relaxed);
+		return true;
+	}
+	static void internalPut16(uint8_t* p, uint32_t v)
+	{
+		p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8);
+	}
+	static void internalPut32(uint8_t* p, uint32_t v)
+	{
+		p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+	}
+	static uint32_t internalGet16(const uint8_t* p)
+	{
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8);
+	}
+	static uint32_t internalGet32(const uint8_t* p)
+	{
+		return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+	}
+	// converts to the native value, and applies to the DSP objects
+	void ApplyParam(int ip, float v)
+	{
+		switch(ip)
+		{
+			case ParamID::InstPortamentoTime: mInstrument.SetPortamentoTime(VocoderParamMaps::InstPortamentoTime.ControlToNative(v)); break;
+			case ParamID::InstAttackTime: mInstrument.SetAttackTime(VocoderParamMaps::InstAttackTime.ControlToNative(v)); break;
+			case ParamID::InstReleaseTime: mInstrument.SetReleaseTime(VocoderParamMaps::InstReleaseTime.ControlToNative(v)); break;
+			case ParamID::InstLFORate: mInstrument.SetLFORate(VocoderParamMaps::InstLFORate.ControlToNative(v)); break;
+			case ParamID::InstModRange: mInstrument.SetModRange(VocoderParamMaps::InstModRange.ControlToNative(v)); break;
+			case ParamID::InstBendRange: mInstrument.SetBendRange(VocoderParamMaps::InstBendRange.ControlToNative(v)); break;
+			case ParamID::InstMonoMode: mInstrument.setMonoMode(VocoderParamMaps::InstMonoMode.ControlToIndex(v) == 0); break;
+			case ParamID::InstUnisonCount: mInstrument.SetUnisonCount(FABB::ParamMap::ControlToNativeInt(VocoderParamMaps::InstUnisonCount, v)); break;
+			case ParamID::InstUnisonDetune: mInstrument.SetUnisonDetune(VocoderParamMaps::InstUnisonDetune.ControlToNative(v)); break;
+			case ParamID::IOCarrierGain: mCarrierGain.SetTarget(VocoderParamMaps::IOCarrierGain.ControlToNative(v)); break;
+			case ParamID::IOModulatorGain: mModulatorGain.SetTarget(VocoderParamMaps::IOModulatorGain.ControlToNative(v)); break;
+			case ParamID::IOOutputGain: mOutputGain.SetTarget(VocoderParamMaps::IOOutputGain.ControlToNative(v)); break;
+			case ParamID::VocNoiseGain: mVocoder.setNoiseGain(VocoderParamMaps::VocNoiseGain.ControlToNative(v)); break;
+			case ParamID::VocBandShift: mVocoder.SetBandShift(FABB::ParamMap::ControlToNativeInt(VocoderParamMaps::VocBandShift, v)); break;
+		}
+	}
+	virtual ~VocoderCore()
+	{
+		mInstThread.reset();
+	}
+	void Prepare(double fs, int maxblock, int nchc, int nchm, int ncho)
+	{
+		mInstThread.reset();
+		mNchC = nchc;
+		mNchM = nchm;
+		mNchO = ncho;
+		mMaxBlockSize = std::max(0, maxblock);
+		mArena.Reserve(FABB::Arena::Footprint<float>((size_t)mMaxBlockSize) + ChannelVocoder::ArenaFootprint(mMaxBlockSize));
+		mInstBuffer = mArena.Allocate<float>((size_t)mMaxBlockSize);
+		mInstrument.Prepare(fs);
+		mVocoder.Prepare(fs, mMaxBlockSize, &mArena);
+		mParamScheduler.Reset();
+		if((ParallelMinBlockSize <= maxblock) && (1 < std::thread::hardware_concurrency()))
+		{
+			mInstThread = std::make_unique<WorkerThread>([this]()
+			{
+#if VOCODER_TRACING
+				TraceRecorder::SetThreadSlot(TraceRecorder::HelperSlot);
+#endif
+				RTSafety::ScopedRealtime rt;
+#if VOCODER_DEADLINE_MONITOR
+				uint64_t tstart = ProcessProfiler::Now();
+				RenderInstrument();
+				mStageLaps.Add(ProfileStage::Instrument, ProcessProfiler::Now() - tstart);
+#else
+				RenderInstrument();
+#endif
+			});
+			mInstThread->Start();
+		}
+		for(auto&& lv : mIOMeters)
+		{
+			lv.SetAttackTC(0.01f * (float)fs);
+			lv.SetReleaseTC(0.1f * (float)fs);
+			lv.Reset();
+		}
+		for(auto&& pk : mBandPeaks)
+		{
+			pk.SetHoldTime(1.0f * (float)fs);
+			pk.SetReleaseTC(0.3f * (float)fs);
+			pk.Reset();
+		}
+#if VOCODER_DEADLINE_MONITOR
+		mDeadlineMonitor.Prepare(fs);
+#endif
+		for(FABB::GridSmootherF* psm : { &mCarrierGain, &mModulatorGain, &mOutputGain })
+		{
+			psm->SetTime(GainSmoothingTC() * (float)fs);
+			psm->Snap();
+			psm->Align();
+		}
+	}
+	void Unprepare()
+	{
+		mInstThread.reset();
+		mInstrument.Unprepare();
+		mVocoder.Unprepare();
+		mNchC = mNchM = mNchO = 0;
+	}
+	// renders mInstLength samples of the instrument into mInstBuffer, called on the helper thread or inline
+	// timed for the deadline monitor by the callers, see VOCODER_STAGE_SCOPE
+	void RenderInstrument()
+	{
+		VOCODER_PROFILE_SCOPE(mProfiler, Instrument);
+		VOCODER_TRACE_SCOPE(mTracer, Instrument);
+		std::fill(mInstBuffer, mInstBuffer + mInstLength, 0.0f);
+		mScheduler.ProcessAdd(mInstrument, mInstBuffer, mInstLength);
+	}
+	// ppch: nch channels of len samples, the carrier ones, then the modulator ones, and the output is written from the first one
+	// midi: the events of the block in the time order, e.g. juce::MidiBuffer,
+	// iterated as the items which have samplePosition, data and numBytes
+	template<class TMidi> void Process(float* const* ppch, int nch, int len, const TMidi& midi)
+	{
+#if VOCODER_PROFILING
+		uint64_t tstart = mProfiler.BeginBlock();
+#endif
+#if VOCODER_DEADLINE_MONITOR
+		mStageLaps.Begin();
+#endif
+		{
+			VOCODER_TRACE_SCOPE(mTracer, Total);
+			internalProcess(ppch, nch, len, midi);
+		}
+#if VOCODER_PROFILING
+		mProfiler.EndBlock(tstart);
+#endif
+#if VOCODER_DEADLINE_MONITOR
+		mDeadlineMonitor.Process(len, mStageLaps.End(), &mStageLaps.mTimes);
+#endif
+	}
+	template<class TMidi> void internalProcess(float* const* ppch, int nch, int lenbuf, const TMidi& midi)
+	{
+		if((mNchC < 1) || (mNchM < 1) || (mNchO < 1) || (nch < (mNchC + mNchM)) || (nch < mNchO)) { return; }
+		{
+			VOCODER_STAGE_SCOPE(Params);
+			ApplyParamChanges();
+		}
+		for(auto&& lv : mIOMeters) lv.mStats.Reset();
+		// split the block at the scheduled parameter changes, the MIDI events go to the segment they fall in
+		auto itm = midi.begin();
+		for(int ipos = 0; ipos < lenbuf; )
+		{
+			int iend;
+			{
+				VOCODER_STAGE_SCOPE(Params);
+				mParamScheduler.TakeChanges(ipos, [this](int ip, float v)
+				{
+					mChunk[ip].store(v, std::memory_order_relaxed);
+					ApplyParam(ip, v);
+				});
+				iend = mParamScheduler.NextChange(ipos, lenbuf);
+				for(; (itm != midi.end()) && ((*itm).samplePosition < iend); ++ itm)
+				{
+					const auto mm = *itm;
+					// a program change is swapped in at the start of the segment
+					if((1 < mm.numBytes) && ((mm.data[0] & 0xf0U) == 0xc0U)) internalApplyProgram(mm.data[1]);
+					else mScheduler.Add(std::max(0, mm.samplePosition - ipos), mm.data, mm.numBytes);
+				}
+			}
+			if(mMaxBlockSize < (iend - ipos)) internalProcessInPlace(ppch, ipos, iend - ipos);
+			else internalProcessSegment(ppch, ipos, iend - ipos);
+			ipos = iend;
+		}
+		mParamScheduler.Advance(lenbuf);
+		internalPublishLevels(lenbuf);
+	}
+	// processes len samples from ipos, len must not exceed mMaxBlockSize
+	void internalProcessSegment(float* const* ppch, int ipos, int len)
+	{
+		int ichc = 0;
+		int ichm = ichc + mNchC;
+		int icho = 0;
+		// dispatch the instrument rendering
+		// the analysis runs while the helper thread renders the instrument,
+		// otherwise the fused Process() is used, which is faster than Analyze() and Synthesize() in series
+		mInstLength = len;
+		bool parallel = mInstThread && (ParallelMinBlockSize <= len);
+		if(parallel) mInstThread->Dispatch();
+		else
+		{
+			VOCODER_LAP_SCOPE(mStageLaps, Instrument);
+			RenderInstrument();
+		}
+		// mix modulator channels into ch2 with the gain
+		float* pm = ppch[ichm] + ipos;
+		{
+			VOCODER_STAGE_SCOPE(IO);
+			const float* pm1 = (1 < mNchM) ? (ppch[ichm + 1] + ipos) : nullptr;
+			mModulatorGain.Ramp(len, [&](int i, int l, float g0, float dg)
+			{
+				if(pm1) FABB::GainStage::SumGain(pm + i, pm1 + i, pm + i, l, g0, dg, &mIOMeters[1].mStats);
+				else FABB::GainStage::Gain(pm + i, l, g0, dg, &mIOMeters[1].mStats);
+			});
+		}
+		if(parallel)
+		{
+			{
+				VOCODER_STAGE_SCOPE(Analysis);
+				mVocoder.Analyze(pm, len);
+			}
+			mInstThread->Join();
+#if VOCODER_DEADLINE_MONITOR
+			mStageLaps.Skip(); // the wait is left out of the stages, as in the profiler
+#endif
+		}
+		// mix carrier channels into the rendered instrument with the gain
+		float* pc = mInstBuffer;
+		{
+			VOCODER_STAGE_SCOPE(IO);
+			const float* pc0 = ppch[ichc] + ipos;
+			const float* pc1 = (1 < mNchC) ? (ppch[ichc + 1] + ipos) : nullptr;
+			mCarrierGain.Ramp(len, [&](int i, int l, float g0, float dg)
+			{
+				if(pc1) FABB::GainStage::SumGain(pc + i, pc0 + i, pc1 + i, pc + i, l, g0, dg, &mIOMeters[0].mStats);
+				else FABB::GainStage::SumGain(pc + i, pc0 + i, pc + i, l, g0, dg, &mIOMeters[0].mStats);
+			});
+		}
+		// synthesize, the fused analysis is profiled as Synthesis
+		float* po = ppch[icho] + ipos;
+		{
+			VOCODER_STAGE_SCOPE(Synthesis);
+			if(parallel) mVocoder.Synthesize(pc, po, len);
+			else mVocoder.Process(pc, pm, po, len);
+		}
+		// output with the gain
+		{
+			VOCODER_STAGE_SCOPE(IO);
+			internalOutputGain(ppch, icho, ipos, len);
+		}
+	}
+	// fallback for the segments longer than prepared, renders the instrument in place into the carrier channel
+	// the analysis is not separated from the synthesis in this path, and is profiled as Synthesis
+	void internalProcessInPlace(float* const* ppch, int ipos, int len)
+	{
+		int ichc = 0;
+		int ichm = ichc + mNchC;
+		int icho = 0;
+		// mix rendered instrument and carrier channels into ch0 with the gain
+		float* pc = ppch[ichc] + ipos;
+		{
+			VOCODER_STAGE_SCOPE(Instrument);
+			mScheduler.ProcessAdd(mInstrument, pc, len);
+		}
+		float* pm = ppch[ichm] + ipos;
+		{
+			VOCODER_STAGE_SCOPE(IO);
+			const float* pc1 = (1 < mNchC) ? (ppch[ichc + 1] + ipos) : nullptr;
+			mCarrierGain.Ramp(len, [&](int i, int l, float g0, float dg)
+			{
+				if(pc1) FABB::GainStage::SumGain(pc + i, pc1 + i, pc + i, l, g0, dg, &mIOMeters[0].mStats);
+				else FABB::GainStage::Gain(pc + i, l, g0, dg, &mIOMeters[0].mStats);
+			});
+			// mix modulator channels into ch2 with the gain
+			const float* pm1 = (1 < mNchM) ? (ppch[ichm + 1] + ipos) : nullptr;
+			mModulatorGain.Ramp(len, [&](int i, int l, float g0, float dg)
+			{
+				if(pm1) FABB::GainStage::SumGain(pm + i, pm1 + i, pm + i, l, g0, dg, &mIOMeters[1].mStats);
+				else FABB::GainStage::Gain(pm + i, l, g0, dg, &mIOMeters[1].mStats);
+			});
+		}
+		// process vocoder
+		float* po = ppch[icho] + ipos;
+		{
+			VOCODER_STAGE_SCOPE(Synthesis);
+			mVocoder.Process(pc, pm, po, len);
+		}
+		// output with the gain
+		{
+			VOCODER_STAGE_SCOPE(IO);
+			internalOutputGain(ppch, icho, ipos, len);
+		}
+	}
+	// applies the output gain to the synthesized channel, and fans it out to the next channel
+	void internalOutputGain(float* const* ppch, int icho, int ipos, int len)
+	{
+		float* po = ppch[icho] + ipos;
+		float* po1 = (1 < mNchO) ? (ppch[icho + 1] + ipos) : nullptr;
+		mOutputGain.Ramp(len, [&](int i, int l, float g0, float dg)
+		{
+			if(po1) FABB::GainStage::GainFanOut(po + i, po + i, po1 + i, l, g0, dg, &mIOMeters[2].mStats);
+			else FABB::GainStage::Gain(po + i, l, g0, dg, &mIOMeters[2].mStats);
+		});
+	}
+	// builds the meter snapshot at the block end, and publishes it to the readers
+	void internalPublishLevels(int lenbuf)
+	{
+		VocoderLevels& lv = mLevelsWork;
+		for(size_t c = mIOMeters.size(), i = 0; i < c; i ++)
+		{
+			lv.ios[i] = mIOMeters[i].Process(mIOMeters[i].mStats.peak, lenbuf);
+			lv.iopeaks[i] = mIOMeters[i].mStats.peak;
+			lv.iorms[i] = mIOMeters[i].mStats.RMS();
+		}
+		mVocoder.GetModLevels(&lv.modbands);
+		mVocoder.TakeModRMS(&lv.modbandrms);
+		for(size_t c = mBandPeaks.size(), i = 0; i < c; i ++) lv.modbandpeaks[i] = mBandPeaks[i].Process(lv.modbands[i], lenbuf);
+		mLevels.Store(lv);
+	}
+	// wait-free for the audio thread, can be called from any thread
+	void GetLevels(VocoderLevels* pv) const
+	{
+		mLevels.Load(pv);
+	}
+#if VOCODER_PROFILING
+	void GetProfileStats(ProfileStats* pv) const
+	{
+		mProfiler.GetStats(pv);
+	}
+	void ResetProfileStats()
+	{
+		mProfiler.RequestReset();
+	}
+#endif
+#if VOCODER_DEADLINE_MONITOR
+	void GetDeadlineStats(DeadlineStats* pv) const
+	{
+		mDeadlineMonitor.GetStats(pv);
+	}
+	void ResetDeadlineStats()
+	{
+		mDeadlineMonitor.RequestReset();
+	}
+#endif
+#if VOCODER_TRACING
+	TraceRecorder& GetTracer()
+	{
+		return mTracer;
+	}
+#endif
+};
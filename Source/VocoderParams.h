@@ -0,0 +1,83 @@
+//
+//  VocoderParams.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "FABB/ParamMap.h"
+#include <array>
+
+// the parameters of the vocoder, defined once in VOCODER_PARAMS
+// X(id, key, nameunit, param, valueconvert, stringconvert), the sections of a ParamConverter profile line (cf. ParamConvert.h)
+// valueconvert is composed of the regions below, and is expanded both into the <valueconverter> string of gParamProfile,
+// and into the typed maps of VocoderParamMaps used on the audio thread, so that the two forms cannot diverge
+// MapPt(vc, vn)						: "pt!vc!vn"
+// MapLin(vcl, vch, vnl, vnh)			: "lin!vcl~vch!vnl~vnh"
+// MapExp(vcl, vch, vnl, vnh)			: "exp!vcl~vch!vnl~vnh"
+// MapEnum(vcl, vch, (n0,n1,...))		: "enum!vcl~vch!n0,n1,..."
+// MapEither(region, region)			: "region; region"
+#define VOCODER_PARAMS(X) \
+	/* instrument */ \
+	X(InstPortamentoTime,	"IPT",	"Portamento;sec.",	"0~1;N0.01",	MapExp(0, 1, 0.001, 1),					"exp!0~1!0.001~1!%.3f,x!%f,x") \
+	X(InstAttackTime,		"IAT",	"Attack;sec.",		"0~1;N0.01",	MapExp(0, 1, 0.001, 1),					"exp!0~1!0.001~1!%.3f,x!%f,x") \
+	X(InstReleaseTime,		"IRT",	"Release;sec.",		"0~1;N0.01",	MapExp(0, 1, 0.001, 1),					"exp!0~1!0.001~1!%.3f,x!%f,x") \
+	X(InstLFORate,			"ILR",	"LFORate;Hz",		"0~1;N5",		MapExp(0, 1, 0.1, 100),					"exp!0~1!0.1~100!%.2f,x!%f,x") \
+	X(InstModRange,			"IMR",	"ModRange",			"0~1;N2",		MapLin(0, 1, 0, 12),					"pt!0!Off; lin!0~1!0~12!%.2f,x!%f,x") \
+	X(InstBendRange,		"IBR",	"BendRange",		"0~1;N2",		MapLin(0, 1, 0, 12),					"pt!0!Off; lin!0~1!0~12!%.2f,x!%f,x") \
+	X(InstMonoMode,			"IMM",	"Mode",				"0~1;N1",		MapEnum(0, 1, (0,1)),					"enum!0~1!mono,poly") \
+	X(InstUnisonCount,		"IUC",	"Unison",			"0~1;N1;int",	MapLin(0, 1, 1, 8),						"lin!0~1!1~8!%.0f,x!%f,x") \
+	X(InstUnisonDetune,		"IUD",	"Detune;cent",		"0~1;N0.1",		MapLin(0, 1, 0, 1),						"lin!0~1!0~100!%.1f,x!%f,x") \
+	/* io */ \
+	X(IOCarrierGain,		"CG",	"Carrier;dB",		"0~1;N2",		MapEither(MapPt(0, 0), MapExp(0, 1, 0.1, 10)),	"pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x") \
+	X(IOModulatorGain,		"MG",	"Modulator;dB",		"0~1;N2",		MapEither(MapPt(0, 0), MapExp(0, 1, 0.1, 10)),	"pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x") \
+	X(IOOutputGain,			"OG",	"Output;dB",		"0~1;N2",		MapEither(MapPt(0, 0), MapExp(0, 1, 0.1, 10)),	"pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x") \
+	/* vocoder */ \
+	X(VocNoiseGain,			"NG",	"Noise;dB",			"0~1;N0.5",		MapEither(MapPt(0, 0), MapExp(0, 1, 0.1, 10)),	"pt!0!Off; lin!0~1!-20~20!%.1f,x!%f,x") \
+	X(VocBandShift,			"BS",	"Band Shift",		"0~1;N0;int",	MapLin(0, 1, -4, 4),					"lin!0~1!-4~4!%.0f,x!%f,x")
+
+// for the internal use, the regions expanded into the profile string
+#define VOCODER_PARAM_STR_MapPt(vc, vn) "pt!" #vc "!" #vn
+#define VOCODER_PARAM_STR_MapLin(vcl, vch, vnl, vnh) "lin!" #vcl "~" #vch "!" #vnl "~" #vnh
+#define VOCODER_PARAM_STR_MapExp(vcl, vch, vnl, vnh) "exp!" #vcl "~" #vch "!" #vnl "~" #vnh
+#define VOCODER_PARAM_STR_MapEnum(vcl, vch, values) "enum!" #vcl "~" #vch "!" VOCODER_PARAM_STR_LIST values
+#define VOCODER_PARAM_STR_LIST(...) #__VA_ARGS__
+#define VOCODER_PARAM_STR_MapEither(a, b) VOCODER_PARAM_STR_##a "; " VOCODER_PARAM_STR_##b
+// for the internal use, the regions expanded into the typed maps
+#define VOCODER_PARAM_MAP_MapPt(vc, vn) FABB::ParamMap::Pt(vc, vn)
+#define VOCODER_PARAM_MAP_MapLin(vcl, vch, vnl, vnh) FABB::ParamMap::Lin(vcl, vch, vnl, vnh)
+#define VOCODER_PARAM_MAP_MapExp(vcl, vch, vnl, vnh) FABB::ParamMap::Exp(vcl, vch, vnl, vnh)
+#define VOCODER_PARAM_MAP_MapEnum(vcl, vch, values) FABB::ParamMap::Enum(vcl, vch, std::array { VOCODER_PARAM_LIST values })
+#define VOCODER_PARAM_LIST(...) __VA_ARGS__
+#define VOCODER_PARAM_MAP_MapEither(a, b) FABB::ParamMap::Either(VOCODER_PARAM_MAP_##a, VOCODER_PARAM_MAP_##b)
+
+struct ParamID
+{
+	enum
+	{
+#define VOCODER_PARAM_ID(id, key, nameunit, param, valueconvert, stringconvert) id,
+		VOCODER_PARAMS(VOCODER_PARAM_ID)
+#undef VOCODER_PARAM_ID
+		Count,
+	};
+};
+
+// the ParamConverter profile, in the order of ParamID
+inline const char* const gParamProfile[] =
+{
+#define VOCODER_PARAM_PROFILE(id, key, nameunit, param, valueconvert, stringconvert) key "\t" nameunit "\t" param "\t" VOCODER_PARAM_STR_##valueconvert "\t" stringconvert,
+	VOCODER_PARAMS(VOCODER_PARAM_PROFILE)
+#undef VOCODER_PARAM_PROFILE
+};
+static_assert(sizeof(gParamProfile) / sizeof(gParamProfile[0]) == ParamID::Count, "gParamProfile must have all the parameters");
+
+// the typed form of the value converters, named after ParamID
+namespace VocoderParamMaps
+{
+#define VOCODER_PARAM_TYPEDMAP(id, key, nameunit, param, valueconvert, stringconvert) inline constexpr auto id = VOCODER_PARAM_MAP_##valueconvert;
+	VOCODER_PARAMS(VOCODER_PARAM_TYPEDMAP)
+#undef VOCODER_PARAM_TYPEDMAP
+}
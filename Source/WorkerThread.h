@@ -0,0 +1,100 @@
+//
+//  WorkerThread.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include "FABB/Semaphore.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (1 <= _M_IX86_FP))
+#include <xmmintrin.h>
+#endif
+#if !defined(_WIN32)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// runs a task on a helper thread, dispatched and joined by the audio thread
+// the handoff is lock-free both ways, Dispatch() never blocks, and Join() spins for a bounded time before it blocks,
+// the helper also spins for a while after a task, to catch the next segment of the same block without a wakeup
+class WorkerThread
+{
+public:
+	enum { JoinSpin = 4096, IdleSpin = 1024 };
+	std::function<void()> mTask;
+	FABB::Semaphore mStart, mDone;
+	std::atomic<bool> mExit;
+	std::thread mThread;
+	explicit WorkerThread(std::function<void()> task) : mTask(task), mExit(false)
+	{
+	}
+	virtual ~WorkerThread()
+	{
+		Stop();
+	}
+	void Start()
+	{
+		if(mThread.joinable()) return;
+		mExit.store(false, std::memory_order_relaxed);
+		mThread = std::thread([this]() { internalRun(); });
+		internalRaisePriority();
+	}
+	// must not be called between Dispatch() and Join()
+	void Stop()
+	{
+		if(!mThread.joinable()) return;
+		mExit.store(true, std::memory_order_relaxed);
+		mStart.Post();
+		mThread.join();
+	}
+	void Dispatch()
+	{
+		mStart.Post();
+	}
+	// the task is expected to be finished already, or very soon
+	void Join()
+	{
+		mDone.Wait(JoinSpin);
+	}
+	// for the internal use
+	void internalRun()
+	{
+		internalDisableDenormals(); // the denormal mode is per thread
+		for(;;)
+		{
+			mStart.Wait(IdleSpin);
+			if(mExit.load(std::memory_order_relaxed)) break;
+			mTask();
+			mDone.Post();
+		}
+	}
+	// best effort, the realtime class needs the privilege on some systems
+	void internalRaisePriority()
+	{
+#if defined(_WIN32)
+		SetThreadPriority((HANDLE)mThread.native_handle(), THREAD_PRIORITY_HIGHEST);
+#else
+		sched_param sp = {};
+		sp.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+		pthread_setschedparam(mThread.native_handle(), SCHED_FIFO, &sp);
+#endif
+	}
+	// flush-to-zero and denormals-are-zero
+	static void internalDisableDenormals()
+	{
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (1 <= _M_IX86_FP))
+		_mm_setcsr(_mm_getcsr() | 0x8040);
+#elif defined(__aarch64__)
+		uint64_t fpcr;
+		__asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+		__asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr | (1ull << 24)));
+#endif
+	}
+};
@@ -0,0 +1,103 @@
+//
+//  DeadlineMonitorTest.cpp
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+//  feeds known block times into DeadlineMonitor, and checks the counters, the worst block and the JSON,
+//  then checks that VocoderCore reports the stage breakdown of the worst block in the default build
+//
+
+#include "TestContext.h"
+#include "TestFixtures.h"
+#include "VocoderCore.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if VOCODER_DEADLINE_MONITOR
+
+using Stages = std::array<uint64_t, ProfileStage::Count>;
+
+static void CheckCounters(TestContext& tc)
+{
+	DeadlineMonitor dm;
+	dm.Prepare(48000);
+	// 480 samples, i.e. the budget is 10ms, the loads at the thresholds exactly are not counted as exceeded
+	const uint64_t elapsed[] = { 4000000, 6000000, 9000000, 12000000, 7900000, 5000000, 8000000, 10000000 };
+	const Stages worst = { 1000, 2000, 3000, 4000, 5000, 0 };
+	const Stages other = { 9, 9, 9, 9, 9, 0 };
+	for(uint64_t t : elapsed) dm.Process(480, t, (t == 12000000) ? &worst : &other);
+	dm.Process(0, 99000000); // ignored
+	DeadlineStats st;
+	dm.GetStats(&st);
+	tc.Check(st.blocks == 8, "blocks=%llu", (unsigned long long)st.blocks);
+	tc.Check(st.over50 == 6, "over50=%llu", (unsigned long long)st.over50);
+	tc.Check(st.over80 == 3, "over80=%llu", (unsigned long long)st.over80);
+	tc.Check(st.over100 == 1, "over100=%llu", (unsigned long long)st.over100);
+	tc.Check((st.worstSamples == 480) && (st.worstElapsed == 12000000) && (st.worstBudget == 10000000), "the worst block is %d samples, %llu/%llu ns",
+		st.worstSamples, (unsigned long long)st.worstElapsed, (unsigned long long)st.worstBudget);
+	std::string json = DeadlineMonitor::ToJSON(st);
+	const char* golden =
+		"{\"blocks\":8,\"over50\":6,\"over80\":3,\"over100\":1,"
+		"\"worst\":{\"load\":1.2000,\"samples\":480,\"elapsedUs\":12000.000,\"budgetUs\":10000.000,"
+		"\"stagesUs\":{\"Params\":1.000,\"Instrument\":2.000,\"Analysis\":3.000,\"Synthesis\":4.000,\"IO\":5.000,\"Total\":12000.000}}}";
+	tc.Check(json == golden, "ToJSON gives %s", json.c_str());
+	// the reset is taken at the next block, which has no stage breakdown
+	dm.RequestReset();
+	dm.Process(64, 500000);
+	dm.GetStats(&st);
+	tc.Check((st.blocks == 1) && (st.over50 == 0) && (st.over80 == 0) && (st.over100 == 0), "the counters are not reset");
+	tc.Check(st.worstBudget == 1333333, "the budget of 64 samples is %llu ns", (unsigned long long)st.worstBudget);
+	tc.Check((st.worstStages[ProfileStage::Synthesis] == 0) && (st.worstStages[ProfileStage::Total] == 500000), "the stages of the worst block are not reset");
+}
+
+static void CheckCore(TestContext& tc)
+{
+	const int maxblock = 512, nch = 2;
+	auto core = std::make_unique<VocoderCore>();
+	core->Prepare(48000, maxblock, 1, 1, 1);
+	std::vector<std::vector<float>> buffers(nch, std::vector<float>(maxblock));
+	std::vector<float*> channels(nch);
+	for(int ich = 0; ich < nch; ich ++) channels[ich] = buffers[ich].data();
+	static const uint8_t noteon[] = { 0x90, 60, 100 };
+	std::vector<MidiEvent> events = { { 0, noteon, 3 } }, none;
+	for(int iblk = 0; iblk < 100; iblk ++)
+	{
+		for(auto&& b : buffers) for(int i = 0; i < maxblock; i ++) b[i] = (float)((iblk * maxblock + i) % 100) * 0.01f;
+		core->Process(channels.data(), nch, maxblock, (iblk == 0) ? events : none);
+	}
+	DeadlineStats st;
+	core->GetDeadlineStats(&st);
+	tc.Check(st.blocks == 100, "VocoderCore: blocks=%llu", (unsigned long long)st.blocks);
+	tc.Check(st.worstStages[ProfileStage::Total] == st.worstElapsed, "VocoderCore: the Total stage is not the elapsed time");
+	// the instrument may be rendered on the helper thread in parallel with the others
+	uint64_t sum = 0;
+	for(int i = 0; i < ProfileStage::Total; i ++) sum += (i != ProfileStage::Instrument) ? st.worstStages[i] : 0;
+	tc.Check(sum <= st.worstElapsed, "VocoderCore: the stages on the audio thread sum up to %llu ns, more than the block %llu ns", (unsigned long long)sum, (unsigned long long)st.worstElapsed);
+	tc.Check(st.worstStages[ProfileStage::Instrument] <= st.worstElapsed, "VocoderCore: the Instrument stage is longer than the block");
+	for(int stage : { ProfileStage::Instrument, ProfileStage::Synthesis, ProfileStage::IO })
+	{
+		tc.Check(0 < st.worstStages[stage], "VocoderCore: the %s stage of the worst block is not timed", ProfileStage::Name(stage));
+	}
+}
+
+int main()
+{
+	TestContext tc("DeadlineMonitor");
+	CheckCounters(tc);
+	CheckCore(tc);
+	return tc.Result();
+}
+
+#else
+
+int main()
+{
+	TestContext tc("DeadlineMonitor");
+	return tc.Result();
+}
+
+#endif
@@ -0,0 +1,159 @@
+//
+//  FastMathTest.cpp
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+//  checks the max error bounds documented in FABB/FastMath.h over the documented domains, against double precision
+//
+
+#include "TestContext.h"
+#include "FABB/FastMath.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// the worst ratio of the error to the bound over the samples
+struct ErrorScan
+{
+	double worst = 0, x = 0, y = 0, err = 0, bound = 0;
+	void Add(double error, double b, double vx, double vy = 0)
+	{
+		double r = error / b;
+		if(!(r <= worst)) { worst = r; err = error; bound = b; x = vx; y = vy; } // NaN is the worst
+	}
+	void Report(TestContext& tc, const char* name) const
+	{
+		tc.Check(worst <= 1, "%s: error %.3g exceeds %.3g at x=%.9g y=%.9g", name, err, bound, x, y);
+		std::fprintf(stderr, "  %-6s worst error/bound %.3f\n", name, worst);
+	}
+};
+
+// the samples of [lo,hi], evenly spaced, the ends and the integers included
+static std::vector<float> Domain(float lo, float hi, int n)
+{
+	std::vector<float> v;
+	for(int i = 0; i <= n; i ++) v.push_back((float)(lo + (hi - lo) * ((double)i / n)));
+	for(float x = std::ceil(lo); x <= hi; x += 1) v.push_back(x);
+	// pseudo-random ones, deterministic
+	uint32_t seed = 22222;
+	for(int i = 0; i < n; i ++)
+	{
+		seed = seed * 196314165u + 907633515u;
+		v.push_back((float)(lo + (hi - lo) * ((double)seed / 4294967296.0)));
+	}
+	return v;
+}
+
+// the normal positive floats, the mantissas sampled in each binade
+static std::vector<float> Normals(int permantissa)
+{
+	std::vector<float> v;
+	for(int e = 1; e < 255; e ++)
+	{
+		for(int i = 0; i < permantissa; i ++)
+		{
+			uint32_t m = (uint32_t)(((uint64_t)i * 0x7fffff) / (uint64_t)(permantissa - 1));
+			uint32_t bits = ((uint32_t)e << 23) | m;
+			float x; std::memcpy(&x, &bits, sizeof(x));
+			v.push_back(x);
+		}
+	}
+	return v;
+}
+
+static double RelError(double v, double r)
+{
+	return std::abs(v - r) / std::abs(r);
+}
+
+int main()
+{
+	TestContext tc("FastMath");
+	const double Ln2 = 0.6931471805599453;
+	{
+		ErrorScan es;
+		for(float x : Domain(-126, 127, 1 << 20)) es.Add(RelError(FABB::FastMath::Exp2(x), std::exp2((double)x)), 2.5e-7, x);
+		es.Report(tc, "Exp2");
+	}
+	{
+		ErrorScan es;
+		for(float x : Domain(-87, 88, 1 << 20)) es.Add(RelError(FABB::FastMath::Exp(x), std::exp((double)x)), (std::abs(x) <= 1) ? 2.5e-7 : 4.0e-6, x);
+		es.Report(tc, "Exp");
+	}
+	{
+		ErrorScan es;
+		for(float x : Normals(4096)) { double r = std::log2((double)x); es.Add(std::abs(FABB::FastMath::Log2(x) - r), 1.2e-7 * std::max(1.0, std::abs(r)), x); }
+		es.Report(tc, "Log2");
+	}
+	{
+		ErrorScan es;
+		for(float x : Normals(4096)) { double r = std::log((double)x); es.Add(std::abs(FABB::FastMath::Log(x) - r), 1.4e-7 * std::max(1.0, std::abs(r)), x); }
+		es.Report(tc, "Log");
+	}
+	{
+		// the bound composed as documented, Exp2 at y=b*log2(a), with the Log2 error and the rounding of y carried through 2^y
+		ErrorScan es;
+		std::vector<float> as = Domain(1.0e-3f, 1.0e3f, 2048), bs = Domain(-12, 12, 512);
+		for(float a : as)
+		{
+			for(float b : bs)
+			{
+				double y = (double)b * std::log2((double)a);
+				if((y < -126) || (127 < y)) continue;
+				double dy = std::abs(b) * 1.2e-7 * std::max(1.0, std::abs(std::log2((double)a))) + std::abs(y) * 6.0e-8;
+				es.Add(RelError(FABB::FastMath::Pow(a, b), std::pow((double)a, (double)b)), 2.5e-7 + Ln2 * dy * 1.01, a, b);
+			}
+		}
+		es.Report(tc, "Pow");
+	}
+	{
+		ErrorScan ess, esc;
+		for(float x : Domain(-8192, 8192, 1 << 22))
+		{
+			ess.Add(std::abs(FABB::FastMath::Sin(x) - std::sin((double)x)), 2.5e-7, x);
+			esc.Add(std::abs(FABB::FastMath::Cos(x) - std::cos((double)x)), 2.5e-7, x);
+		}
+		ess.Report(tc, "Sin");
+		esc.Report(tc, "Cos");
+	}
+	{
+		// Sin/Cos with their absolute errors, so that the error is relative to 1/cos(x)^2, and does not vanish at the zeros
+		ErrorScan es;
+		for(float x : Domain(-8192, 8192, 1 << 22))
+		{
+			double r = std::tan((double)x);
+			es.Add(std::abs(FABB::FastMath::Tan(x) - r), 2.0e-7 * (1 + std::abs(r)) * (1 + std::abs(r)), x);
+		}
+		es.Report(tc, "Tan");
+	}
+	// the array versions are the same code as the scalar ones
+	{
+		std::vector<float> xs = Domain(-80, 80, 4096), ys(xs.size());
+		using ArrayFn = void(*)(const float*, float*, size_t);
+		using ScalarFn = float(*)(float);
+		struct { const char* name; ArrayFn fa; ScalarFn fs; } fns[] =
+		{
+			{ "Exp2[]", FABB::FastMath::Exp2, FABB::FastMath::Exp2 },
+			{ "Exp[]", FABB::FastMath::Exp, FABB::FastMath::Exp },
+			{ "Sin[]", FABB::FastMath::Sin, FABB::FastMath::Sin },
+			{ "Cos[]", FABB::FastMath::Cos, FABB::FastMath::Cos },
+			{ "Tan[]", FABB::FastMath::Tan, FABB::FastMath::Tan },
+		};
+		for(auto&& fn : fns)
+		{
+			fn.fa(xs.data(), ys.data(), xs.size());
+			size_t i = 0;
+			for(; i < xs.size(); i ++)
+			{
+				float v = fn.fs(xs[i]);
+				if(std::memcmp(&ys[i], &v, sizeof(v)) != 0) break;
+			}
+			tc.Check(i == xs.size(), "%s differs from the scalar version at x=%.9g", fn.name, (i < xs.size()) ? xs[i] : 0.0f);
+		}
+	}
+	return tc.Result();
+}
@@ -0,0 +1,241 @@
+//
+//  ParamConvertTest.cpp
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+//  checks the array conversions of ParamConverter against the scalar ones, on the signals which cross the regions,
+//  Format/Parse of every parameter against the golden strings, and MathExpression::Compiled against the known values
+//
+
+#include "TestContext.h"
+#include "VocoderParams.h"
+#include "FABB/ParamConvert.h"
+#include "FABB/MathExpression.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// the parameters of the vocoder, and a few with more regions, the unit prefixes and the multiple arguments
+static const char* const gExtraProfile[] =
+{
+	"R3\tRegions\t0~1;N0.5\tpt!0!0; lin!0~0.5!1~10; exp!0.5~1!10~1000\tlin!0~1!0~1!%.2f,x!%f,x",
+	"PT\tPoints\t0~1;N0\tpt!0!-1; pt!1!1; lin!0~1!-0.5~0.5\tlin!0~1!0~1!%.2f,x!%f,x",
+	"FQ\tFrequency;Hz\t0~1;N1000\texp!0~1!20~20000\texp!0~1!20~20000!%kHz,x!%kHz,x",
+	"TM\tTime;s\t0~1;N0.5\texp!0~1!0.00002~2000\texp!0~1!0.00002~2000!%.3ks,x!%ks,x",
+	"PN\tPan\t0~1;N50\tlin!0~1!0~100\tlin!0~1!0~100!L%.0f:R%.0f,100-x,x!L%f,100-x",
+};
+
+// the display texts at the control values below, and the control values which the texts are parsed back into
+static const float gGoldenControls[] = { 0.0f, 0.1f, 0.25f, 0.5f, 0.75f, 1.0f };
+struct GoldenText
+{
+	const char* key;
+	const char* texts[6];
+	float parsed[6];
+};
+static const GoldenText gGoldenTexts[] =
+{
+	{ "IPT", { "0.001", "0.002", "0.006", "0.032", "0.178", "1.000" }, { 0, 0.100343f, 0.259384f, 0.501717f, 0.75014f, 1 } },
+	{ "IAT", { "0.001", "0.002", "0.006", "0.032", "0.178", "1.000" }, { 0, 0.100343f, 0.259384f, 0.501717f, 0.75014f, 1 } },
+	{ "IRT", { "0.001", "0.002", "0.006", "0.032", "0.178", "1.000" }, { 0, 0.100343f, 0.259384f, 0.501717f, 0.75014f, 1 } },
+	{ "ILR", { "0.10", "0.20", "0.56", "3.16", "17.78", "100.00" }, { 0, 0.100343f, 0.249396f, 0.499896f, 0.749977f, 1 } },
+	{ "IMR", { "Off", "1.20", "3.00", "6.00", "9.00", "12.00" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "IBR", { "Off", "1.20", "3.00", "6.00", "9.00", "12.00" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "IMM", { "mono", "mono", "mono", "poly", "poly", "poly" }, { 0, 0, 0, 1, 1, 1 } },
+	{ "IUC", { "1", "2", "3", "4", "6", "8" }, { 0, 0.142857f, 0.285714f, 0.428571f, 0.714286f, 1 } },
+	{ "IUD", { "0.0", "10.0", "25.0", "50.0", "75.0", "100.0" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "CG", { "Off", "-16.0", "-10.0", "0.0", "10.0", "20.0" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "MG", { "Off", "-16.0", "-10.0", "0.0", "10.0", "20.0" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "OG", { "Off", "-16.0", "-10.0", "0.0", "10.0", "20.0" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "NG", { "Off", "-16.0", "-10.0", "0.0", "10.0", "20.0" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "BS", { "-4", "-3", "-2", "0", "2", "4" }, { 0, 0.125f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "FQ", { "20.00Hz", "39.91Hz", "112.5Hz", "632.5Hz", "3.557kHz", "20.00kHz" }, { 0, 0.100017f, 0.250041f, 0.50001f, 0.750018f, 1 } },
+	{ "TM", { "20.0us", "126us", "2.00ms", "200ms", "20.0s", "2.00ks" }, { 0, 0.0999176f, 0.25f, 0.5f, 0.75f, 1 } },
+	{ "PN", { "L100:R0", "L90:R10", "L75:R25", "L50:R50", "L25:R75", "L0:R100" }, { 0, 0.1f, 0.25f, 0.5f, 0.75f, 1 } },
+};
+
+// the texts typed in, the unit prefixes in either case, out of the range, not parsed at all (the default), and the enum items matched partly
+struct ParsedText
+{
+	const char* key;
+	const char* text;
+	float parsed;
+};
+static const ParsedText gParsedTexts[] =
+{
+	{ "FQ", "1kHz", 0.566323f },
+	{ "FQ", "1.5KHz", 0.625021f },
+	{ "FQ", "2.5k", 0.69897f },
+	{ "FQ", "440Hz", 0.447474f },
+	{ "FQ", "1000mHz", 0 },
+	{ "FQ", "0.5MHz", 1 },
+	{ "FQ", "bogus", 0.566323f },
+	{ "TM", "2m", 0.25f },
+	{ "TM", "20us", 0 },
+	{ "IPT", "1000", 1 },
+	{ "CG", "Off", 0 },
+	{ "CG", "-20", 0 },
+	{ "IMM", "poly", 1 },
+	{ "IMM", "po", 1 },
+	{ "IMM", "m", 0 },
+};
+
+// the same bits, so that NaN equals NaN
+static bool Same(float a, float b)
+{
+	return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// the values which cross the regions of pc in the several patterns, including the ones out of the range
+static std::vector<float> Signal(const FABB::ParamConverter& pc, bool native)
+{
+	auto f = [&](float vc) { return native ? pc.ControlToNative(vc) : vc; };
+	const float vcmin = pc.ControlMin(), vcmax = pc.ControlMax(), vcmid = (vcmin + vcmax) * 0.5f;
+	std::vector<float> v;
+	for(int i = 0; i <= 1000; i ++) v.push_back(f(vcmin + (vcmax - vcmin) * (float)i / 1000.0f));
+	for(int i = 0; i < 1000; i ++) v.push_back(f((i & 1) ? vcmid : vcmin)); // alternating between the regions
+	for(int i = 0; i < 1000; i ++) v.push_back(f((i & 1) ? (vcmin + (vcmax - vcmin) * 0.25f) : (vcmin + (vcmax - vcmin) * 0.75f)));
+	for(int i = 0; i < 1000; i ++) v.push_back((i & 1) ? f(vcmid) : (vcmax + 1) * 100); // alternating with the values out of all the regions
+	for(int i = 0; i < 100; i ++) v.push_back(f((i % 3) ? vcmax : vcmin));
+	uint32_t seed = 12345;
+	for(int i = 0; i < 1000; i ++)
+	{
+		seed = seed * 196314165u + 907633515u;
+		int r = (int)(seed >> 29);
+		v.push_back((r < 6) ? f(vcmin + (vcmax - vcmin) * (float)r / 5.0f) : ((r == 6) ? f(vcmin) - 1 : f(vcmax) + 1));
+	}
+	return v;
+}
+
+static void CheckArrays(TestContext& tc, const FABB::ParamConverter& pc)
+{
+	std::vector<float> vc = Signal(pc, false), vn(vc.size());
+	pc.ControlToNative(vc.data(), vn.data(), vc.size());
+	for(size_t i = 0; i < vc.size(); i ++)
+	{
+		float v = pc.ControlToNative(vc[i]);
+		tc.Check(Same(vn[i], v), "%s: ControlToNative[%d](%.9g) = %.9g, the scalar one gives %.9g", pc.Key(), (int)i, vc[i], vn[i], v);
+	}
+	vn = Signal(pc, true);
+	vc.resize(vn.size());
+	pc.NativeToControl(vn.data(), vc.data(), vn.size());
+	for(size_t i = 0; i < vn.size(); i ++)
+	{
+		float v = pc.NativeToControl(vn[i]);
+		tc.Check(Same(vc[i], v), "%s: NativeToControl[%d](%.9g) = %.9g, the scalar one gives %.9g", pc.Key(), (int)i, vn[i], vc[i], v);
+	}
+	// the empty array
+	pc.ControlToNative(vc.data(), vn.data(), 0);
+}
+
+static void CheckTexts(TestContext& tc, const FABB::ParamConverterTable& table, const FABB::ParamConverterTable& extra)
+{
+	size_t n = 0;
+	for(auto&& g : gGoldenTexts)
+	{
+		const FABB::ParamConverter* pc = table[g.key] ? table[g.key] : extra[g.key];
+		tc.Check(pc != nullptr, "%s: not found", g.key);
+		if(!pc) continue;
+		for(size_t i = 0; i < 6; i ++)
+		{
+			float vc = gGoldenControls[i];
+			std::string s = pc->Format(vc);
+			tc.Check(s == g.texts[i], "%s: Format(%g) gives \"%s\", expected \"%s\"", g.key, vc, s.c_str(), g.texts[i]);
+			char buf[FABB::ParamConverter::MaxTextLength];
+			bool ok = pc->Format(vc, buf, sizeof(buf));
+			tc.Check(ok && (s == buf), "%s: Format(%g) into the buffer gives \"%s\"", g.key, vc, buf);
+			float p = pc->Parse(g.texts[i]);
+			tc.Check(std::abs(p - g.parsed[i]) <= 1e-5f, "%s: Parse(\"%s\") gives %.9g, expected %.9g", g.key, g.texts[i], p, g.parsed[i]);
+		}
+		n ++;
+	}
+	tc.Check(n == table.Count() + 3, "%d parameters have the golden texts, %d expected", (int)n, (int)table.Count() + 3);
+	for(auto&& g : gParsedTexts)
+	{
+		const FABB::ParamConverter* pc = table[g.key] ? table[g.key] : extra[g.key];
+		float p = pc ? pc->Parse(g.text) : -1;
+		tc.Check(std::abs(p - g.parsed) <= 1e-5f, "%s: Parse(\"%s\") gives %.9g, expected %.9g", g.key, g.text, p, g.parsed);
+	}
+}
+
+// the short buffers truncate the text, always terminated, and nothing is written beyond them
+static void CheckTruncation(TestContext& tc, const FABB::ParamConverterTable& table, const FABB::ParamConverterTable& extra)
+{
+	struct { const char* key; float vc; } cases[] = { { "FQ", 1.0f }, { "FQ", 0.75f }, { "TM", 0.0f }, { "PN", 0.1f }, { "CG", 0.0f }, { "CG", 0.1f }, { "IMM", 1.0f } };
+	for(auto&& c : cases)
+	{
+		const FABB::ParamConverter* pc = table[c.key] ? table[c.key] : extra[c.key];
+		std::string full = pc->Format(c.vc);
+		for(size_t cs = 0; cs <= full.size() + 1; cs ++)
+		{
+			char buf[16];
+			std::memset(buf, '#', sizeof(buf));
+			bool ok = pc->Format(c.vc, buf, cs);
+			std::string expected = full.substr(0, cs ? (cs - 1) : 0);
+			tc.Check(ok, "%s: Format(%g) into %d bytes fails", c.key, c.vc, (int)cs);
+			tc.Check((cs == 0) || (expected == buf), "%s: Format(%g) into %d bytes gives \"%.*s\", expected \"%s\"", c.key, c.vc, (int)cs, (int)cs, buf, expected.c_str());
+			bool intact = true;
+			for(size_t i = cs; i < sizeof(buf); i ++) intact = intact && (buf[i] == '#');
+			tc.Check(intact, "%s: Format(%g) into %d bytes writes beyond them", c.key, c.vc, (int)cs);
+		}
+	}
+}
+
+static void CheckExpression(TestContext& tc)
+{
+	struct { const char* expr; double x, value; } cases[] =
+	{
+		{ "x*100", 0.25, 25 },
+		{ "(x^2)-(2*x)+1", 0.25, 0.5625 },
+		{ "20*log10(x)", 0.25, -12.041199826559248 },
+		{ "exp2(x)", 0.25, 1.189207115002721 },
+		{ "%pi*x", 0.25, 0.78539816339744828 },
+		{ "%e^x", 1, 2.7182818284590452 },
+		{ "-x+1", 0.25, 0.75 },
+		{ "x<0.5", 0.25, 1 },
+		{ "x<0.5", 0.75, 0 },
+		{ "sqrt(x)", 0.25, 0.5 },
+		{ "1/x", 0.25, 4 },
+		{ "2^10", 0, 1024 },
+		{ "(1+2)*3", 0, 9 },
+		{ "1+2*3", 0, 9 }, // no priority, in order
+		{ "100-x", 25, 75 },
+	};
+	for(auto&& c : cases)
+	{
+		FABB::MathExpression::Compiled ce(c.expr);
+		double v = -1, vs = -2;
+		bool ok = ce.IsValid() && ce.Evaluate(c.x, &v);
+		tc.Check(ok && (std::abs(v - c.value) <= 1e-12 * std::max(1.0, std::abs(c.value))), "Compiled(\"%s\").Evaluate(%g) gives %.17g, expected %.17g", c.expr, c.x, v, c.value);
+		FABB::MathExpression::Evaluate(c.expr, c.x, &vs);
+		tc.Check(v == vs, "Compiled(\"%s\").Evaluate(%g) gives %.17g, the string version %.17g", c.expr, c.x, v, vs);
+		float vf = -1;
+		ce.Evaluate((float)c.x, &vf);
+		tc.Check(std::abs(vf - (float)c.value) <= 1e-6f * std::max(1.0f, std::abs((float)c.value)), "Compiled(\"%s\").Evaluate(%gf) gives %.9g", c.expr, c.x, vf);
+	}
+	for(const char* expr : { "", "(x", "x+", "foo(x)" })
+	{
+		std::string err;
+		FABB::MathExpression::Compiled ce(expr, &err);
+		double v = 0;
+		tc.Check(!ce.IsValid() && !err.empty() && !ce.Evaluate(0.5, &v), "Compiled(\"%s\") is not rejected", expr);
+	}
+}
+
+int main()
+{
+	TestContext tc("ParamConvert");
+	FABB::ParamConverterTable table(gParamProfile, sizeof(gParamProfile) / sizeof(gParamProfile[0]));
+	for(size_t i = 0; i < table.Count(); i ++) CheckArrays(tc, *table[i]);
+	FABB::ParamConverterTable extra(gExtraProfile, sizeof(gExtraProfile) / sizeof(gExtraProfile[0]));
+	tc.Check(extra.Count() == 5, "the extra profile has %d parameters", (int)extra.Count());
+	for(size_t i = 0; i < extra.Count(); i ++) CheckArrays(tc, *extra[i]);
+	CheckTexts(tc, table, extra);
+	CheckTruncation(tc, table, extra);
+	CheckExpression(tc);
+	return tc.Result();
+}
@@ -0,0 +1,114 @@
+//
+//  ParamMapTest.cpp
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+//  checks that the typed maps of VocoderParamMaps give the same mappings as the ParamConverters parsed from gParamProfile,
+//  over the control range of every parameter, and around every region boundary
+//
+
+#include "TestContext.h"
+#include "VocoderParams.h"
+#include "FABB/ParamConvert.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+// the control values where the region changes, and the native values at the region ends
+static void Boundaries(const FABB::ParamMap::Pt& m, std::vector<float>* pvc, std::vector<float>* pvn)
+{
+	pvc->push_back(m.mVc);
+	pvn->push_back(m.mVn);
+}
+static void Boundaries(const FABB::ParamMap::Lin& m, std::vector<float>* pvc, std::vector<float>* pvn)
+{
+	pvc->insert(pvc->end(), { m.mVcl, m.mVch });
+	pvn->insert(pvn->end(), { m.mVnl, m.mVnh });
+}
+static void Boundaries(const FABB::ParamMap::Exp& m, std::vector<float>* pvc, std::vector<float>* pvn)
+{
+	pvc->insert(pvc->end(), { m.mVcl, m.mVch });
+	pvn->insert(pvn->end(), { m.mVnl, m.mVnh });
+}
+template<size_t N> static void Boundaries(const FABB::ParamMap::Enum<N>& m, std::vector<float>* pvc, std::vector<float>* pvn)
+{
+	pvc->insert(pvc->end(), { m.mVcl, m.mVch });
+	// the index is rounded, so that it changes halfway between the values
+	for(size_t i = 0; i + 1 < N; i ++) pvc->push_back(m.mIndexMap.NativeToControl((float)i + 0.5f));
+	for(int v : m.mValues) pvn->push_back((float)v);
+}
+template<class TA, class TB> static void Boundaries(const FABB::ParamMap::Either<TA, TB>& m, std::vector<float>* pvc, std::vector<float>* pvn)
+{
+	Boundaries(m.mA, pvc, pvn);
+	Boundaries(m.mB, pvc, pvn);
+}
+
+// allows a few ulps, for the compilers which contract the multiply-adds differently in the inlined code, cf. ParamMap::Matches()
+static bool Same(float a, float b)
+{
+	return (a == b) || (std::abs(a - b) <= 1e-6f * std::max(std::abs(a), std::abs(b)));
+}
+
+template<class TMap> static void CheckParam(TestContext& tc, const char* name, const TMap& m, const FABB::ParamConverter& pc)
+{
+	const float vcmin = pc.ControlMin(), vcmax = pc.ControlMax();
+	std::vector<float> vcs, vns;
+	Boundaries(m, &vcs, &vns);
+	// each boundary and its neighbours, within the control range
+	std::vector<float> points;
+	for(float b : vcs)
+	{
+		for(float vc : { std::nextafter(b, -std::numeric_limits<float>::infinity()), b, std::nextafter(b, std::numeric_limits<float>::infinity()) })
+		{
+			if((vcmin <= vc) && (vc <= vcmax)) points.push_back(vc);
+		}
+	}
+	for(int i = 0; i <= 4096; i ++) points.push_back(vcmin + (vcmax - vcmin) * (float)i / 4096.0f);
+	for(float vc : points)
+	{
+		float vn = pc.ControlToNative(vc);
+		float vnt = m.ControlToNative(vc);
+		tc.Check(Same(vnt, vn), "%s: ControlToNative(%.9g) = %.9g, the profile gives %.9g", name, vc, vnt, vn);
+		tc.Check(Same(m.NativeToControl(vn), pc.NativeToControl(vn)), "%s: NativeToControl(%.9g) = %.9g, the profile gives %.9g", name, vn, m.NativeToControl(vn), pc.NativeToControl(vn));
+		if(pc.IsInteger())
+		{
+			int vi = FABB::ParamMap::ControlToNativeInt(m, vc);
+			tc.Check(vi == pc.ControlToNativeInt(vc), "%s: ControlToNativeInt(%.9g) = %d, the profile gives %d", name, vc, vi, pc.ControlToNativeInt(vc));
+		}
+	}
+	for(float vn : vns)
+	{
+		tc.Check(Same(m.NativeToControl(vn), pc.NativeToControl(vn)), "%s: NativeToControl(%.9g) = %.9g at the region end, the profile gives %.9g", name, vn, m.NativeToControl(vn), pc.NativeToControl(vn));
+	}
+}
+
+template<size_t N> static void CheckEnum(TestContext& tc, const char* name, const FABB::ParamMap::Enum<N>& m, const FABB::ParamConverter& pc)
+{
+	tc.Check(pc.IsEnum() && (pc.GetEnumCount() == (int)N), "%s: the profile has %d enum values, the typed map has %d", name, pc.GetEnumCount(), (int)N);
+	for(int i = 0; i <= 4096; i ++)
+	{
+		float vc = pc.ControlMin() + (pc.ControlMax() - pc.ControlMin()) * (float)i / 4096.0f;
+		tc.Check(m.ControlToIndex(vc) == pc.ControlToEnumIndex(vc), "%s: ControlToIndex(%.9g) = %d, the profile gives %d", name, vc, m.ControlToIndex(vc), pc.ControlToEnumIndex(vc));
+	}
+}
+template<class TMap> static void CheckEnum(TestContext&, const char*, const TMap&, const FABB::ParamConverter&)
+{
+}
+
+int main()
+{
+	TestContext tc("ParamMap");
+	FABB::ParamConverterTable table(gParamProfile, sizeof(gParamProfile) / sizeof(gParamProfile[0]));
+	tc.Check(table.Count() == ParamID::Count, "the profile has %d parameters, ParamID has %d", (int)table.Count(), (int)ParamID::Count);
+	if(table.Count() != ParamID::Count) return tc.Result();
+#define VOCODER_PARAM_CHECK(id, key, nameunit, param, valueconvert, stringconvert) \
+	tc.Check(std::string(table[ParamID::id]->Key()) == key, "%s: the key is %s", #id, table[ParamID::id]->Key()); \
+	CheckParam(tc, #id, VocoderParamMaps::id, *table[ParamID::id]); \
+	CheckEnum(tc, #id, VocoderParamMaps::id, *table[ParamID::id]);
+	VOCODER_PARAMS(VOCODER_PARAM_CHECK)
+#undef VOCODER_PARAM_CHECK
+	return tc.Result();
+}
@@ -0,0 +1,238 @@
+//
+//  RTSafetyTest.cpp
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+//  drives VocoderCore::Process with adversarial MIDI and automation under the real-time safety checker (see RTSafetyChecker.h),
+//  and fails when any allocation or lock is detected on the audio thread
+//  built with VOCODER_RTCHECK=1
+//
+
+#include "TestContext.h"
+#include "TestFixtures.h"
+#include "VocoderCore.h"
+#include "RTSafetyChecker.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if !VOCODER_RTCHECK
+#error "RTSafetyTest needs VOCODER_RTCHECK=1"
+#endif
+
+static void* volatile gSink = nullptr;
+
+// each operation in a real-time scope must be reported once, otherwise the harness below proves nothing
+static void CheckTheChecker(TestContext& tc)
+{
+	struct Probe { const char* name; void* (*alloc)(); void (*release)(void*); };
+	const Probe probes[] =
+	{
+		{ "malloc", []() { return std::malloc(16); }, [](void* p) { std::free(p); } },
+		{ "calloc", []() { return std::calloc(4, 16); }, [](void* p) { std::free(p); } },
+		{ "realloc", []() { return std::realloc(nullptr, 16); }, [](void* p) { std::free(p); } },
+		{ "operator new", []() { return (void*)new int[4]; }, [](void* p) { delete[] (int*)p; } },
+		{ "posix_memalign", []() { void* p = nullptr; return (posix_memalign(&p, 64, 64) == 0) ? p : nullptr; }, [](void* p) { std::free(p); } },
+#if defined(__GLIBC__)
+		{ "aligned_alloc", []() { return aligned_alloc(64, 64); }, [](void* p) { std::free(p); } },
+		{ "memalign", []() { return memalign(64, 64); }, [](void* p) { std::free(p); } },
+		{ "valloc", []() { return valloc(64); }, [](void* p) { std::free(p); } },
+		{ "pvalloc", []() { return pvalloc(64); }, [](void* p) { std::free(p); } },
+#endif
+	};
+	for(auto&& pr : probes)
+	{
+		RTSafety::ResetViolationCount();
+		{
+			RTSafety::ScopedRealtime rt;
+			gSink = pr.alloc();
+		}
+		uint64_t n = RTSafety::GetViolationCount();
+		pr.release(gSink);
+		tc.Check(n == 1, "%s in a real-time scope was reported %llu times", pr.name, (unsigned long long)n);
+	}
+#if !defined(_WIN32)
+	{
+		std::mutex m;
+		RTSafety::ResetViolationCount();
+		{
+			RTSafety::ScopedRealtime rt;
+			m.lock();
+			m.unlock();
+		}
+		tc.Check(RTSafety::GetViolationCount() == 1, "pthread_mutex_lock in a real-time scope was not reported");
+	}
+#endif
+	RTSafety::ResetViolationCount();
+	{
+		RTSafety::ScopedRealtime rt;
+		RTSafety::ScopedAllow allow;
+		gSink = std::malloc(16);
+	}
+	std::free(gSink);
+	tc.Check(RTSafety::GetViolationCount() == 0, "an allowed allocation was reported");
+}
+
+// the messages a host may pass, and some it should not
+static const uint8_t gNoteOn[] = { 0x90, 60, 100 };
+static const uint8_t gNoteOff[] = { 0x80, 60, 0 };
+static const uint8_t gNoteOnV0[] = { 0x90, 60, 0 };
+static const uint8_t gModWheel[] = { 0xb0, 1, 127 };
+static const uint8_t gSustain[] = { 0xb0, 64, 127 };
+static const uint8_t gAllNotesOff[] = { 0xb0, 123, 0 };
+static const uint8_t gAllSoundOff[] = { 0xb0, 120, 0 };
+static const uint8_t gBendMin[] = { 0xe0, 0, 0 };
+static const uint8_t gBendMax[] = { 0xe0, 127, 127 };
+static const uint8_t gPressure[] = { 0xd0, 127 };
+static const uint8_t gPolyPressure[] = { 0xa0, 60, 127 };
+static const uint8_t gClock[] = { 0xf8 };
+static const uint8_t gSysEx[] = { 0xf0, 0x7e, 0x7f, 0x09, 0x01, 0xf7 };
+static const uint8_t gTruncated[] = { 0x90 };
+
+// builds the events of a block, in the time order, into the reserved storage
+static void BuildMidi(Random& rnd, int len, std::vector<MidiEvent>* pev, std::vector<uint8_t>* pdata)
+{
+	pev->clear();
+	pdata->clear();
+	auto add = [&](int pos, const uint8_t* p, int l)
+	{
+		size_t off = pdata->size();
+		pdata->insert(pdata->end(), p, p + l);
+		pev->push_back({ pos, (const uint8_t*)(uintptr_t)off, l }); // rebased below, the storage may move
+	};
+	auto note = [&](int pos, uint8_t status, uint8_t vel)
+	{
+		uint8_t m[3] = { (uint8_t)(status | rnd.Int(16)), (uint8_t)rnd.Int(128), vel };
+		add(pos, m, 3);
+	};
+	switch(rnd.Int(6))
+	{
+		case 0: // note flood, beyond the capacity of the instrument queue
+			for(int i = 0; i < 3000; i ++) note(rnd.Int(len), (rnd.Int(2) == 0) ? 0x90 : 0x80, (uint8_t)rnd.Int(128));
+			break;
+		case 1: // controller bursts, then a note-off which must not be dropped
+			for(int i = 0; i < 2000; i ++)
+			{
+				const uint8_t* cc[] = { gModWheel, gSustain, gBendMin, gBendMax, gPolyPressure };
+				add(rnd.Int(len), cc[rnd.Int(5)], 3);
+			}
+			add(len - 1, gNoteOff, 3);
+			break;
+		case 2: // program changes, including the ones out of the range
+			for(int i = 0; i < 16; i ++)
+			{
+				uint8_t m[2] = { 0xc0, (uint8_t)rnd.Int(128) };
+				add(rnd.Int(len), m, 2);
+			}
+			break;
+		case 3: // the channel mode messages and the odd sizes
+			add(0, gNoteOn, 3);
+			add(0, gNoteOnV0, 3);
+			add(rnd.Int(len), gAllNotesOff, 3);
+			add(rnd.Int(len), gAllSoundOff, 3);
+			add(rnd.Int(len), gPressure, 2);
+			add(rnd.Int(len), gClock, 1);
+			add(rnd.Int(len), gSysEx, (int)sizeof(gSysEx));
+			add(rnd.Int(len), gTruncated, 1);
+			break;
+		default: // a few notes
+			for(int i = 0; i < 8; i ++) note(rnd.Int(len), 0x90, (uint8_t)(1 + rnd.Int(127)));
+			for(int i = 0; i < 8; i ++) note(rnd.Int(len), 0x80, 0);
+			break;
+	}
+	for(auto&& ev : *pev) ev.data = pdata->data() + (uintptr_t)ev.data;
+	std::stable_sort(pev->begin(), pev->end(), [](const MidiEvent& a, const MidiEvent& b) { return a.samplePosition < b.samplePosition; });
+}
+
+// the automation of the host and the GUI, on a control thread
+static void ControlLoop(VocoderCore& core, std::atomic<bool>& stop)
+{
+	Random rnd(33333);
+	std::vector<uint8_t> state(VocoderCore::StateSize());
+	core.SaveState(state.data());
+	std::vector<uint8_t> newer = state, garbage = state;
+	newer[4] = 9; // a future version, with more parameters
+	newer.resize(newer.size() + 16, 0xff);
+	newer[6] = (uint8_t)(ParamID::Count + 4);
+	for(size_t i = VocoderCore::StateHeaderSize; i < garbage.size(); i ++) garbage[i] = (uint8_t)rnd.Int(256); // NaN and the like
+	int64_t time = 0;
+	VocoderLevels lv;
+	while(!stop.load(std::memory_order_relaxed))
+	{
+		for(int i = 0; i < 64; i ++) core.SetParam(rnd.Int(ParamID::Count), (rnd.Int(4) == 0) ? (float)rnd.Int(2) : rnd.Float());
+		time = std::max(time, core.GetSampleTime()) + rnd.Int(64);
+		for(int i = 0; i < 64; i ++) core.ScheduleParam(rnd.Int(ParamID::Count), rnd.Float(), time + i * rnd.Int(8));
+		switch(rnd.Int(8))
+		{
+			case 0: core.SelectProgram(rnd.Int(core.GetProgramCount() + 2) - 1); break;
+			case 1: core.LoadState(state.data(), state.size()); break;
+			case 2: core.LoadState(newer.data(), newer.size()); break;
+			case 3: core.LoadState(garbage.data(), garbage.size()); break;
+			default: break;
+		}
+		core.GetLevels(&lv);
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+}
+
+int main()
+{
+	TestContext tc("RTSafety");
+	CheckTheChecker(tc);
+	const double fs = 48000;
+	const int maxblock = 512;
+	const int nch = 4; // carrier 2, modulator 2, output 2 from the first
+	auto core = std::make_unique<VocoderCore>();
+	core->Prepare(fs, maxblock, 2, 2, 2);
+	std::vector<std::vector<float>> buffers(nch, std::vector<float>(2 * maxblock));
+	std::vector<float*> channels(nch);
+	for(int ich = 0; ich < nch; ich ++) channels[ich] = buffers[ich].data();
+	std::vector<MidiEvent> events;
+	std::vector<uint8_t> data;
+	events.reserve(4096);
+	data.reserve(4096 * 8);
+	std::atomic<bool> stop(false);
+	std::thread control([&]() { ControlLoop(*core, stop); });
+	Random rnd(22222);
+	RTSafety::ResetViolationCount();
+	bool finite = true;
+	const int lengths[] = { 1, 2, 31, 32, 33, 64, 100, 255, 256, 257, 480, 511, 512, 2 * maxblock };
+	for(int iblk = 0; iblk < 2000; iblk ++)
+	{
+		// the host may also pass a block longer than prepared
+		int len = lengths[rnd.Int((int)(sizeof(lengths) / sizeof(lengths[0])))];
+		for(auto&& b : buffers) for(int i = 0; i < len; i ++) b[i] = rnd.Float() * 2 - 1;
+		BuildMidi(rnd, len, &events, &data);
+		{
+			RTSafety::ScopedRealtime rt;
+			core->Process(channels.data(), nch, len, events);
+		}
+		for(int ich = 0; ich < 2; ich ++) for(int i = 0; i < len; i ++) finite = finite && std::isfinite(buffers[ich][i]);
+		if((iblk % 500) == 499)
+		{
+			// the host stops and restarts the processing
+			stop.store(true);
+			control.join();
+			core->Prepare(fs, maxblock, 2, 2, 2);
+			stop.store(false);
+			control = std::thread([&]() { ControlLoop(*core, stop); });
+		}
+	}
+	stop.store(true);
+	control.join();
+	uint64_t violations = RTSafety::GetViolationCount();
+	tc.Check(violations == 0, "%llu violations in VocoderCore::Process, see the stack traces above", (unsigned long long)violations);
+	tc.Check(finite, "the output is not finite");
+	return tc.Result();
+}
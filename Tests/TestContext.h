@@ -0,0 +1,47 @@
+//
+//  TestContext.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cstdarg>
+#include <cstdio>
+
+// counts the checks and the failures of a test executable, the first failures of each check are reported to stderr
+// the test passes when Result() returns 0, which is the exit code for ctest
+class TestContext
+{
+public:
+	enum { MaxReports = 10 };
+	const char* mName;
+	int mChecks;
+	int mFailures;
+	explicit TestContext(const char* name) : mName(name), mChecks(0), mFailures(0)
+	{
+	}
+	// returns ok, the message is printf formatted
+	bool Check(bool ok, const char* fmt, ...)
+	{
+		mChecks ++;
+		if(ok) return true;
+		if(mFailures ++ < MaxReports)
+		{
+			std::fprintf(stderr, "[%s] FAILED: ", mName);
+			va_list ap;
+			va_start(ap, fmt);
+			std::vfprintf(stderr, fmt, ap);
+			va_end(ap);
+			std::fprintf(stderr, "\n");
+		}
+		return false;
+	}
+	int Result() const
+	{
+		std::fprintf(stderr, "[%s] %d checks, %d failures\n", mName, mChecks, mFailures);
+		return (mFailures == 0) ? 0 : 1;
+	}
+};
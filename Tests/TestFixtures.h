@@ -0,0 +1,30 @@
+//
+//  TestFixtures.h
+//  ChannelVocoder
+//
+//  Created by yu2924 on 2026-10-18
+//  (c) 2026 yu2924
+//
+
+#pragma once
+
+#include <cstdint>
+
+// the items of the MIDI sequence given to VocoderCore::Process()
+struct MidiEvent
+{
+	int samplePosition;
+	const uint8_t* data;
+	int numBytes;
+};
+
+// deterministic, so that a failure can be reproduced
+class Random
+{
+public:
+	uint32_t mSeed;
+	explicit Random(uint32_t seed) : mSeed(seed) {}
+	uint32_t Next() { mSeed = mSeed * 196314165u + 907633515u; return mSeed; }
+	int Int(int n) { return (int)((uint64_t)Next() * (uint64_t)n >> 32); }
+	float Float() { return (float)((double)Next() / 4294967296.0); }
+};